@@ -0,0 +1,1002 @@
+#include "Benchmark.h"
+#include "FrameStats.h"
+#include "FramePipeline.h"
+#include "MarkerDictCache.h"
+#include "ImageKernels.h"
+#include "MarkerTracker.h"
+#include "PoseFilter.h"
+#include <cfloat>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// snapshot of the allocation counters
+struct AllocationCount{
+    unsigned long long allocations = 0;
+    unsigned long long bytes = 0;
+
+    static AllocationCount now(){
+        AllocationCount count;
+        count.allocations = FrameStats::allocations.load();
+        count.bytes = FrameStats::bytesAllocated.load();
+        return count;
+    }
+};
+
+// adds the allocations since the snapshot to the stage total
+static void addSince(const AllocationCount& since, AllocationCount& total){
+    AllocationCount current = AllocationCount::now();
+    total.allocations += current.allocations - since.allocations;
+    total.bytes += current.bytes - since.bytes;
+}
+
+// the video and marker dictionary a benchmark runs on, and the loop over its warm-up and measured frames
+struct BenchmarkVideo{
+    cv::VideoCapture cap;
+    MarkerDict dict;
+    cv::Mat frame;              // the current frame
+    int index = -1;             // number of the current frame, counting the warm-up frames
+    int warmupFrames = 0;
+    int totalFrames = 0;
+    bool failed = false;        // a frame could not be read, the results are incomplete
+
+    // opens the video and loads the dictionary, next then reads warmup frames followed by config.frames measured ones
+    bool open(const BenchmarkConfig& config, int warmup){
+        cap.open(config.videoPath, cv::CAP_FFMPEG);
+        if (!cap.isOpened()){
+            cout << "[CV] No video file detected, exiting" << endl;
+            return false;
+        }
+        dict = MarkerDictCache::loadOrBuild(config.markerPath, config.dictionaryCache);
+        warmupFrames = warmup;
+        totalFrames = warmup + config.frames;
+        return true;
+    }
+
+    // reads the next frame, starting over at the end of the video, false once every frame has been read
+    bool next(){
+        if (failed || index + 1 >= totalFrames){
+            return false;
+        }
+        if (!cap.read(frame)){
+            cap.set(cv::CAP_PROP_POS_FRAMES, 0);
+            if (!cap.read(frame)){
+                cout << "[CV] Could not read a frame, exiting" << endl;
+                failed = true;
+                return false;
+            }
+        }
+        index++;
+        return true;
+    }
+
+    // false during the warm-up frames
+    bool measuring() const{
+        return index >= warmupFrames;
+    }
+};
+
+int Benchmark::run(int argc, char const *argv[], BenchmarkConfig config){
+    string name = argc >= 3 ? argv[2] : "";
+    if (argc >= 4){
+        config.frames = max(1, atoi(argv[3]));
+    }
+    if (argc >= 5){
+        config.videoPath = argv[4];
+    }
+
+    if (name == "alloc"){
+        return allocations(config);
+    } else if (name == "decode"){
+        return decodeScaling(config);
+    } else if (name == "sampling"){
+        return samplingComparison(config);
+    } else if (name == "threshold"){
+        return thresholdKernel(config);
+    } else if (name == "adaptive"){
+        return thresholdModes(config);
+    } else if (name == "pyramid"){
+        return pyramidSearch(config);
+    } else if (name == "tracking"){
+        return trackingModes(config);
+    } else if (name == "pose"){
+        return poseFiltering(config);
+    } else if (name == "pnp"){
+        return poseSolvers(config);
+    } else if (name == "batch"){
+        return batchedPoses(config);
+    }
+    cout << "[prog] usage: ./ARchitecture bench <alloc|decode|sampling|threshold|adaptive|pyramid|tracking|pose|pnp|batch> [frames] [video]" << endl;
+    return 1;
+}
+
+int Benchmark::allocations(const BenchmarkConfig& config){
+    if (!FrameStats::countingAllocations){
+        cout << "[bench] allocations are not counted in this build, rebuild with COUNT_ALLOCATIONS defined" << endl;
+        return 1;
+    }
+    FrameStats::installCountingAllocator();
+
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+    FurnitureMeshes furniture;
+    if (!FurnitureModels::loadOrCompile(config.furniturePath, config.furnitureCache, furniture)){
+        return 1;
+    }
+
+    // the render stage needs a GL context, but nothing has to be shown
+    if (!glfwInit()){
+        cout << "[GLFW] Failed to initialize GLFW" << endl;
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    int frame_width = video.cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    int frame_height = video.cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    GLFWwindow* window = glfwCreateWindow(frame_width, frame_height, "bench", NULL, NULL);
+    if (!window){
+        cout << "[GLFW] Failed to create GLFW window" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glewExperimental = GL_TRUE;
+    if (glewInit() != GLEW_OK){
+        cout << "[GLFW] Failed to initialize GLEW" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    if (!GLEW_VERSION_3_3){
+        cout << "[GLFW] An OpenGL 3.3 core profile context is needed, the driver offers " << glGetString(GL_VERSION) << endl;
+        glfwTerminate();
+        return 1;
+    }
+
+    cv::Mat gray;
+    DetectionBuffers detectionBuffers;
+    SceneBuffers sceneBuffers;
+    if (!ObjectRender::initScene(furniture, config.cameraMatrix, config.distCoeffs, frame_width, frame_height, sceneBuffers)){
+        glfwTerminate();
+        return 1;
+    }
+    vector<MarkerResult> markers;
+    vector<cv::Vec3d> rvecs, tvecs;
+
+    // [0] capture, [1] detection, [2] pose estimation, [3] rendering
+    const char* stageNames[4] = {"capture", "detection", "pose estimation", "rendering"};
+    AllocationCount stageTotals[4];
+    long long markersSeen = 0;
+
+    while (true){
+        AllocationCount stageTotalsFrame[4];
+
+        AllocationCount since = AllocationCount::now();
+        if (!video.next()){
+            break;
+        }
+        addSince(since, stageTotalsFrame[0]);
+        const cv::Mat& frame = video.frame;
+        int i = video.index;
+        bool measuring = video.measuring();
+
+        since = AllocationCount::now();
+        MarkerDetection::preprocess(frame, false, 0, 1, gray, detectionBuffers);
+        MarkerDetection::detectMarker(gray, detectionBuffers.frame_thresh, 0, dict, 0, 1, detectionBuffers, markers, false);
+        addSince(since, stageTotalsFrame[1]);
+
+        since = AllocationCount::now();
+        // the default path of FramePipeline::processFrame
+        rvecs.resize(markers.size());
+        tvecs.resize(markers.size());
+        for (int j = 0; j < (int)markers.size(); j++){
+            MarkerDetection::trackPose(markers[j].index, i, dict, markers[j].corners, config.cameraMatrix, config.distCoeffs, detectionBuffers, rvecs[j], tvecs[j]);
+        }
+        addSince(since, stageTotalsFrame[2]);
+
+        since = AllocationCount::now();
+        ObjectRender::drawCameraFrame(frame, sceneBuffers);
+        ObjectRender::drawScene(dict, markers, rvecs, tvecs, sceneBuffers);
+        glfwSwapBuffers(window);
+        addSince(since, stageTotalsFrame[3]);
+
+        if (measuring){
+            for (int s = 0; s < 4; s++){
+                stageTotals[s].allocations += stageTotalsFrame[s].allocations;
+                stageTotals[s].bytes += stageTotalsFrame[s].bytes;
+            }
+            markersSeen += markers.size();
+        }
+    }
+
+    // the same frames through the threaded pipeline the program runs, with its default configuration and the
+    // render loop of main; the counters are process wide, so the capture thread and the workers are included
+    cv::VideoCapture pipelineCap(config.videoPath, cv::CAP_FFMPEG);
+    PipelineConfig pipelineConfig;
+    FramePipeline pipeline(pipelineCap, dict, config.cameraMatrix, config.distCoeffs, pipelineConfig);
+    FrameResult processed;
+    AllocationCount pipelineSince;
+    AllocationCount pipelineTotal;
+    int pipelineFrames = 0;
+    pipeline.start();
+    while (pipelineFrames < config.warmupFrames + config.frames && pipeline.nextResult(processed)){
+        if (pipelineFrames == config.warmupFrames){
+            pipelineSince = AllocationCount::now();
+        }
+        ObjectRender::drawCameraFrame(processed.frame, sceneBuffers);
+        ObjectRender::drawScene(dict, processed.markers, processed.rvecs, processed.tvecs, sceneBuffers);
+        glfwSwapBuffers(window);
+        pipeline.recycle(processed);
+        pipelineFrames++;
+    }
+    int pipelineMeasured = max(pipelineFrames - config.warmupFrames, 0);
+    if (pipelineMeasured > 0){
+        addSince(pipelineSince, pipelineTotal);
+    }
+    pipeline.stop();
+
+    cout << "=========================================" << endl;
+    cout << "[bench] heap allocations per frame, " << config.frames << " frames after " << config.warmupFrames << " warm-up frames, "
+         << (double)markersSeen / config.frames << " markers per frame" << endl;
+    for (int s = 0; s < 4; s++){
+        cout << "\t" << stageNames[s] << ": " << (double)stageTotals[s].allocations / config.frames << " allocations, "
+             << (double)stageTotals[s].bytes / config.frames << " bytes" << endl;
+    }
+    if (pipelineMeasured > 0){
+        cout << "\tthreaded pipeline (" << pipelineConfig.detectionWorkers << " workers, queue depth " << pipelineConfig.queueDepth << ", "
+             << pipelineMeasured << " frames): " << (double)pipelineTotal.allocations / pipelineMeasured << " allocations, "
+             << (double)pipelineTotal.bytes / pipelineMeasured << " bytes" << endl;
+    } else {
+        cout << "\tthreaded pipeline: the video ended during the warm-up frames" << endl;
+    }
+    cout << "=========================================" << endl;
+
+    ObjectRender::releaseScene(sceneBuffers);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return 0;
+}
+
+// true if both runs found the same markers at the same corners in the same order
+static bool sameMarkers(const vector<MarkerResult>& a, const vector<MarkerResult>& b){
+    if (a.size() != b.size()){
+        return false;
+    }
+    for (int i = 0; i < (int)a.size(); i++){
+        if (a[i].index != b[i].index || a[i].corners != b[i].corners){
+            return false;
+        }
+    }
+    return true;
+}
+
+int Benchmark::decodeScaling(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, 0)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // keep a short clip in memory and loop over it
+    vector<cv::Mat> clip(min(config.frames, 60));
+    vector<cv::Mat> clipThresh(clip.size());
+    DetectionBuffers buffers;
+    for (int i = 0; i < (int)clip.size(); i++){
+        if (!video.next()){
+            return 1;
+        }
+        MarkerDetection::preprocess(video.frame, false, 0, 1, clip[i], buffers);
+        buffers.frame_thresh.copyTo(clipThresh[i]);
+    }
+
+    vector<vector<MarkerResult>> reference(clip.size());
+    vector<MarkerResult> markers;
+    long long candidatesSeen = 0;
+    for (int i = 0; i < (int)clip.size(); i++){
+        MarkerDetection::detectMarker(clip[i], clipThresh[i], 0, dict, 0, 1, buffers, reference[i], false);
+        candidatesSeen += buffers.candidates.size();
+    }
+
+    int maxThreads = max(1, (int)thread::hardware_concurrency());
+    cout << "=========================================" << endl;
+    cout << "[bench] detectMarker, " << config.frames << " frames, " << (double)candidatesSeen / clip.size() << " candidates per frame" << endl;
+    double baseline = 0;
+    for (int threads = 1; threads <= maxThreads; threads++){
+        // warm up the scratch buffers and the thread pool
+        for (int i = 0; i < (int)clip.size(); i++){
+            MarkerDetection::detectMarker(clip[i], clipThresh[i], 0, dict, 0, threads, buffers, markers, false);
+        }
+
+        bool identical = true;
+        cv::TickMeter timer;
+        timer.start();
+        for (int i = 0; i < config.frames; i++){
+            MarkerDetection::detectMarker(clip[i % clip.size()], clipThresh[i % clip.size()], 0, dict, 0, threads, buffers, markers, false);
+            identical = identical && sameMarkers(markers, reference[i % clip.size()]);
+        }
+        timer.stop();
+
+        double ms = timer.getTimeMilli() / config.frames;
+        if (threads == 1){
+            baseline = ms;
+        }
+        cout << "\t" << threads << " thread(s): " << ms << " ms per frame, speedup " << baseline / ms
+             << (identical ? "" : ", RESULTS DIFFER from 1 thread") << endl;
+    }
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+int Benchmark::samplingComparison(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, 0)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    cv::Mat gray;
+    DetectionBuffers buffers;
+    DecodeBuffers decodeBuffers;
+    vector<uint8_t> distances;
+
+    long long candidates = 0, sameCodes = 0, differentCells = 0;
+    long long warpMarkers = 0, sampleMarkers = 0, sameMarkers = 0;
+    int64_t warpTicks = 0, sampleTicks = 0;
+    while (video.next()){
+        MarkerDetection::preprocess(video.frame, false, 0, 1, gray, buffers);
+        MarkerDetection::findContourAndSquare(buffers.frame_thresh, buffers, false);
+
+        for (const vector<cv::Point2f>& square : buffers.candidates){
+            uint64_t warpCode, sampleCode;
+            int64_t start = cv::getTickCount();
+            MarkerDetection::getIds(gray, square, 36, decodeBuffers, warpCode, false);
+            int64_t middle = cv::getTickCount();
+            MarkerDetection::sampleIds(gray, square, 36, sampleCode);
+            int64_t end = cv::getTickCount();
+            warpTicks += middle - start;
+            sampleTicks += end - middle;
+
+            int distance;
+            int warpIndex = dict.index.find(warpCode, 0, distances, distance);
+            int sampleIndex = dict.index.find(sampleCode, 0, distances, distance);
+            candidates++;
+            sameCodes += warpCode == sampleCode;
+            differentCells += MarkerCode::hammingDistance(warpCode, sampleCode);
+            warpMarkers += warpIndex != -1;
+            sampleMarkers += sampleIndex != -1;
+            sameMarkers += warpIndex != -1 && warpIndex == sampleIndex;
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMicro = cv::getTickFrequency() / 1e6;
+    long long safeCandidates = max(candidates, 1LL);
+    cout << "=========================================" << endl;
+    cout << "[bench] getIds vs sampleIds on " << config.videoPath << ", " << config.frames << " frames, " << candidates << " candidates" << endl;
+    cout << "\tidentical codes: " << sameCodes << " (" << 100.0 * sameCodes / safeCandidates << "%), "
+         << (double)differentCells / safeCandidates << " differing cells per candidate" << endl;
+    cout << "\tmarkers found: getIds " << warpMarkers << ", sampleIds " << sampleMarkers << ", same marker in both " << sameMarkers << endl;
+    cout << "\ttime per candidate: getIds " << warpTicks / ticksPerMicro / safeCandidates << " us, sampleIds "
+         << sampleTicks / ticksPerMicro / safeCandidates << " us" << endl;
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+int Benchmark::thresholdKernel(const BenchmarkConfig& config){
+    cv::Mat source;
+    cv::VideoCapture cap(config.videoPath, cv::CAP_FFMPEG);
+    if (!cap.isOpened() || !cap.read(source) || source.type() != CV_8UC3){
+        cout << "[CV] No video frame, measuring on random noise" << endl;
+        source.create(1080, 1920, CV_8UC3);
+        cv::randu(source, cv::Scalar::all(0), cv::Scalar::all(256));
+    }
+    cap.release();
+
+    // the detection workers run one frame each, so compare single threaded
+    int previousThreads = cv::getNumThreads();
+    cv::setNumThreads(1);
+
+    const cv::Size sizes[3] = {cv::Size(1280, 720), cv::Size(1920, 1080), cv::Size(3840, 2160)};
+    cout << "=========================================" << endl;
+    cout << "[bench] BGR to inverted binary, " << config.frames << " frames per size, " << ImageKernels::implementation() << " kernel" << endl;
+    for (const cv::Size& size : sizes){
+        cv::Mat frame;
+        cv::resize(source, frame, size);
+
+        cv::Mat grey, thresh, fusedGrey, fusedThresh;
+        // warm up, every buffer reaches its final size
+        cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+        cv::threshold(grey, thresh, 95, 255, cv::THRESH_BINARY);
+        cv::bitwise_not(thresh, thresh);
+        ImageKernels::grayThresholdInv(frame, 95, fusedGrey, fusedThresh);
+        bool identical = cv::norm(grey, fusedGrey, cv::NORM_INF) == 0 && cv::norm(thresh, fusedThresh, cv::NORM_INF) == 0;
+
+        cv::TickMeter threePass;
+        threePass.start();
+        for (int i = 0; i < config.frames; i++){
+            cv::cvtColor(frame, grey, cv::COLOR_BGR2GRAY);
+            cv::threshold(grey, thresh, 95, 255, cv::THRESH_BINARY);
+            cv::bitwise_not(thresh, thresh);
+        }
+        threePass.stop();
+
+        cv::TickMeter fused;
+        fused.start();
+        for (int i = 0; i < config.frames; i++){
+            ImageKernels::grayThresholdInv(frame, 95, fusedGrey, fusedThresh);
+        }
+        fused.stop();
+
+        double threePassMs = threePass.getTimeMilli() / config.frames;
+        double fusedMs = fused.getTimeMilli() / config.frames;
+        cout << "\t" << size.width << "x" << size.height << ": three passes " << threePassMs << " ms, fused " << fusedMs
+             << " ms, speedup " << threePassMs / fusedMs << (identical ? "" : ", OUTPUTS DIFFER") << endl;
+    }
+    cout << "=========================================" << endl;
+
+    cv::setNumThreads(previousThreads);
+    return 0;
+}
+
+int Benchmark::thresholdModes(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // [0] global, [1] adaptive on one thread, [2] adaptive on every core
+    const int maxThreads = max(1, (int)thread::hardware_concurrency());
+    const bool adaptive[3] = {false, true, true};
+    const int threads[3] = {1, 1, maxThreads};
+    DetectionBuffers buffers[3];
+    long long framesWithMarkers[3] = {0, 0, 0};
+    long long markersSeen[3] = {0, 0, 0};
+    int64_t thresholdTicks[3] = {0, 0, 0};
+    int64_t totalTicks[3] = {0, 0, 0};
+
+    cv::Mat gray;
+    vector<MarkerResult> markers;
+    while (video.next()){
+        const cv::Mat& frame = video.frame;
+        bool measuring = video.measuring();
+        for (int m = 0; m < 3; m++){
+            int64_t start = cv::getTickCount();
+            MarkerDetection::preprocess(frame, adaptive[m], 0, threads[m], gray, buffers[m]);
+            int64_t middle = cv::getTickCount();
+            MarkerDetection::detectMarker(gray, buffers[m].frame_thresh, 0, dict, 0, 1, buffers[m], markers, false);
+            int64_t end = cv::getTickCount();
+            if (measuring){
+                thresholdTicks[m] += middle - start;
+                totalTicks[m] += end - start;
+                framesWithMarkers[m] += !markers.empty();
+                markersSeen[m] += markers.size();
+            }
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMilli = cv::getTickFrequency() / 1e3;
+    cout << "=========================================" << endl;
+    cout << "[bench] global vs adaptive threshold on " << config.videoPath << ", " << config.frames << " frames" << endl;
+    for (int m = 0; m < 3; m++){
+        cout << "\t" << (adaptive[m] ? "adaptive" : "global") << ", " << threads[m] << " thread(s): "
+             << 100.0 * framesWithMarkers[m] / config.frames << "% frames with markers, "
+             << (double)markersSeen[m] / config.frames << " markers per frame, "
+             << thresholdTicks[m] / ticksPerMilli / config.frames << " ms binarizing, "
+             << totalTicks[m] / ticksPerMilli / config.frames << " ms per frame" << endl;
+    }
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+int Benchmark::pyramidSearch(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // level 0 is the full resolution search every other level is compared with
+    const int levels = 4;
+    DetectionBuffers buffers[levels];
+    vector<MarkerResult> markers[levels];
+    int64_t preprocessTicks[levels] = {0};
+    int64_t contourTicks[levels] = {0};
+    int64_t detectTicks[levels] = {0};
+    long long markersSeen[levels] = {0};
+    long long matchedMarkers[levels] = {0};
+    double cornerOffsets[levels] = {0};
+
+    cv::Mat gray;
+    while (video.next()){
+        const cv::Mat& frame = video.frame;
+        bool measuring = video.measuring();
+        for (int level = 0; level < levels; level++){
+            int64_t start = cv::getTickCount();
+            MarkerDetection::preprocess(frame, false, level, 1, gray, buffers[level]);
+            int64_t middle = cv::getTickCount();
+            MarkerDetection::detectMarker(gray, buffers[level].frame_thresh, level, dict, 0, 1, buffers[level], markers[level], false);
+            int64_t end = cv::getTickCount();
+            // the contour search alone, on the same binary image
+            MarkerDetection::findContourAndSquare(buffers[level].frame_thresh, buffers[level], false);
+            int64_t contourEnd = cv::getTickCount();
+            if (!measuring){
+                continue;
+            }
+            preprocessTicks[level] += middle - start;
+            detectTicks[level] += end - middle;
+            contourTicks[level] += contourEnd - end;
+            markersSeen[level] += markers[level].size();
+
+            // corner offset to the full resolution search, for the markers both found
+            for (const MarkerResult& reference : markers[0]){
+                for (const MarkerResult& res : markers[level]){
+                    if (res.index != reference.index){
+                        continue;
+                    }
+                    double offset = 0;
+                    for (int c = 0; c < 4; c++){
+                        offset += cv::norm(res.corners[c] - reference.corners[c]);
+                    }
+                    cornerOffsets[level] += offset / 4;
+                    matchedMarkers[level]++;
+                    break;
+                }
+            }
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMilli = cv::getTickFrequency() / 1e3;
+    cout << "=========================================" << endl;
+    cout << "[bench] contour search per pyramid level on " << config.videoPath << ", " << config.frames << " frames" << endl;
+    for (int level = 0; level < levels; level++){
+        cout << "\tlevel " << level << " (scale 1/" << (1 << level) << "): "
+             << contourTicks[level] / ticksPerMilli / config.frames << " ms contour search, "
+             << preprocessTicks[level] / ticksPerMilli / config.frames << " ms preprocessing, "
+             << detectTicks[level] / ticksPerMilli / config.frames << " ms detection, "
+             << (double)markersSeen[level] / config.frames << " markers per frame, mean corner offset to level 0 "
+             << cornerOffsets[level] / max(matchedMarkers[level], 1LL) << " px" << endl;
+    }
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+// true if both lists contain the same dictionary indices, in any order
+static bool sameIndices(const vector<MarkerResult>& a, const vector<MarkerResult>& b){
+    if (a.size() != b.size()){
+        return false;
+    }
+    for (const MarkerResult& res : a){
+        bool found = false;
+        for (const MarkerResult& other : b){
+            found = found || other.index == res.index;
+        }
+        if (!found){
+            return false;
+        }
+    }
+    return true;
+}
+
+int Benchmark::trackingModes(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // [0] regions, [1] optical flow, both compared with the full frame detection of every frame
+    const int keyframeInterval = 10;
+    const char* modeNames[2] = {"regions", "optical flow"};
+    MarkerTracker trackers[2] = {MarkerTracker(keyframeInterval, false), MarkerTracker(keyframeInterval, true)};
+    DetectionBuffers fullBuffers, trackedBuffers[2];
+    vector<MarkerResult> fullMarkers, trackedMarkers[2];
+    cv::Mat fullGray, trackedGray[2];
+
+    int64_t fullTicks = 0, trackedTicks[2] = {0, 0};
+    long long fullSeen = 0, trackedSeen[2] = {0, 0}, fullScans[2] = {0, 0}, agreeing[2] = {0, 0};
+    long long matchedMarkers[2] = {0, 0};
+    double searchedArea[2] = {0, 0}, cornerOffsets[2] = {0, 0};
+
+    while (video.next()){
+        const cv::Mat& frame = video.frame;
+        int i = video.index;
+        bool measuring = video.measuring();
+
+        int64_t start = cv::getTickCount();
+        MarkerDetection::preprocess(frame, false, 0, 1, fullGray, fullBuffers);
+        MarkerDetection::detectMarker(fullGray, fullBuffers.frame_thresh, 0, dict, 0, 1, fullBuffers, fullMarkers, false);
+        if (measuring){
+            fullTicks += cv::getTickCount() - start;
+            fullSeen += fullMarkers.size();
+        }
+
+        for (int m = 0; m < 2; m++){
+            MarkerTracker& tracker = trackers[m];
+            DetectionBuffers& buffers = trackedBuffers[m];
+            vector<MarkerResult>& markers = trackedMarkers[m];
+            cv::Mat& gray = trackedGray[m];
+
+            // the same steps as FramePipeline::processFrame
+            start = cv::getTickCount();
+            bool fullScan;
+            bool followed = false;
+            if (tracker.usesOpticalFlow()){
+                MarkerDetection::toGray(frame, gray);
+                followed = tracker.follow(i, gray, buffers, markers);
+                fullScan = !followed;
+            } else {
+                fullScan = tracker.plan(i, frame.size(), buffers.regions);
+            }
+            if (fullScan){
+                MarkerDetection::preprocess(frame, false, 0, 1, gray, buffers);
+                MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, markers, false);
+            } else if (!followed){
+                MarkerDetection::preprocessRegions(frame, false, 1, buffers.regions, gray, buffers);
+                MarkerDetection::findContourAndSquareInRegions(buffers.frame_thresh, buffers.regions, buffers);
+                MarkerDetection::decodeCandidates(gray, dict, 0, 1, buffers, markers, false);
+            }
+            tracker.update(i, fullScan, gray, markers, buffers);
+            int64_t end = cv::getTickCount();
+
+            if (!measuring){
+                continue;
+            }
+            trackedTicks[m] += end - start;
+            trackedSeen[m] += markers.size();
+            fullScans[m] += fullScan;
+            agreeing[m] += sameIndices(fullMarkers, markers);
+            if (fullScan){
+                searchedArea[m] += 1;
+            } else {
+                for (const cv::Rect& region : buffers.regions){
+                    searchedArea[m] += (double)region.area() / frame.total();
+                }
+            }
+            // how far the tracked corners are from the detected ones
+            for (const MarkerResult& reference : fullMarkers){
+                for (const MarkerResult& res : markers){
+                    if (res.index != reference.index){
+                        continue;
+                    }
+                    double offset = 0;
+                    for (int c = 0; c < 4; c++){
+                        offset += cv::norm(res.corners[c] - reference.corners[c]);
+                    }
+                    cornerOffsets[m] += offset / 4;
+                    matchedMarkers[m]++;
+                    break;
+                }
+            }
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMilli = cv::getTickFrequency() / 1e3;
+    cout << "=========================================" << endl;
+    cout << "[bench] full frame detection vs tracking (full scan every " << keyframeInterval << " frames) on "
+         << config.videoPath << ", " << config.frames << " frames" << endl;
+    cout << "\tfull frame: " << fullTicks / ticksPerMilli / config.frames << " ms per frame, "
+         << (double)fullSeen / config.frames << " markers per frame" << endl;
+    for (int m = 0; m < 2; m++){
+        cout << "\t" << modeNames[m] << ": " << trackedTicks[m] / ticksPerMilli / config.frames << " ms per frame, "
+             << (double)trackedSeen[m] / config.frames << " markers per frame, " << 100.0 * fullScans[m] / config.frames << "% full scans, "
+             << 100.0 * searchedArea[m] / config.frames << "% of the frame area searched, same markers as the full detection in "
+             << 100.0 * agreeing[m] / config.frames << "% of the frames, mean corner offset "
+             << cornerOffsets[m] / max(matchedMarkers[m], 1LL) << " px" << endl;
+    }
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+int Benchmark::poseFiltering(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, 0)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+    // the frames are timed by the video, not by how fast they are read
+    double fps = video.cap.get(cv::CAP_PROP_FPS);
+    double frameTime = 1.0 / (fps > 0 ? fps : 30.0);
+
+    PoseFilter filter(dict.codes.size() / 4);
+    DetectionBuffers buffers;
+    vector<MarkerResult> markers;
+    cv::Mat gray;
+    cv::Vec3d rvec, tvec, filteredRvec, filteredTvec;
+    vector<cv::Point2f> raw, filtered;
+    // cube points of every marker image in the previous frame, to measure how much they move from frame to frame
+    vector<vector<cv::Point2f>> previousRaw(dict.codes.size() / 4), previousFiltered(dict.codes.size() / 4);
+    double rawMotion = 0, filteredMotion = 0;
+    long long motionSamples = 0;
+
+    while (video.next()){
+        double time = video.index * frameTime;
+        MarkerDetection::preprocess(video.frame, false, 0, 1, gray, buffers);
+        MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, markers, false);
+        for (const MarkerResult& res : markers){
+            int markerId = res.index / 4;
+            MarkerDetection::solvePose(dict.orientations[res.index], res.corners, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+            filter.update(markerId, time, rvec, tvec);
+            filter.predict(markerId, time, filteredRvec, filteredTvec);
+            MarkerDetection::projectCube(rvec, tvec, config.cameraMatrix, config.distCoeffs, raw);
+            MarkerDetection::projectCube(filteredRvec, filteredTvec, config.cameraMatrix, config.distCoeffs, filtered);
+
+            if (previousRaw[markerId].size() == raw.size()){
+                for (int p = 0; p < (int)raw.size(); p++){
+                    rawMotion += cv::norm(raw[p] - previousRaw[markerId][p]);
+                    filteredMotion += cv::norm(filtered[p] - previousFiltered[markerId][p]);
+                }
+                motionSamples += raw.size();
+            }
+            previousRaw[markerId] = raw;
+            previousFiltered[markerId] = filtered;
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+    double videoMicros = filter.microsPerUpdate();
+
+    // the update cost alone, with as many markers as the dictionary has, on made up poses
+    int markerCount = dict.codes.size() / 4;
+    PoseFilter synthetic(markerCount);
+    cv::RNG rng(1);
+    for (int i = 0; i < 10000; i++){
+        for (int m = 0; m < markerCount; m++){
+            cv::Vec3d r(CV_PI + rng.gaussian(0.01), rng.gaussian(0.01), rng.gaussian(0.01));
+            cv::Vec3d t(m + rng.gaussian(0.01), rng.gaussian(0.01), 10 + rng.gaussian(0.01));
+            synthetic.update(m, i * frameTime, r, t);
+        }
+    }
+
+    cout << "=========================================" << endl;
+    cout << "[bench] pose filter on " << config.videoPath << ", " << config.frames << " frames" << endl;
+    cout << "\tupdate: " << videoMicros << " us per marker on the video, " << synthetic.microsPerUpdate()
+         << " us per marker with " << markerCount << " markers" << endl;
+    cout << "\tcube point motion from frame to frame: measured " << rawMotion / max(motionSamples, 1LL)
+         << " px, filtered " << filteredMotion / max(motionSamples, 1LL) << " px" << endl;
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+// the pose the cold iterative solver starts from: the homography of the marker plane split into rotation and translation
+static void homographyPose(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Vec3d& rvec, cv::Vec3d& tvec){
+    vector<cv::Point2f> plane(4), normalized;
+    for (int i = 0; i < 4; i++){
+        plane[i] = cv::Point2f(orientations[i].x, orientations[i].y);
+    }
+    cv::undistortPoints(corners, normalized, cameraMatrix, distCoeffs);
+    cv::Mat H = cv::findHomography(plane, normalized);
+
+    double norm1 = 0, norm2 = 0;
+    for (int r = 0; r < 3; r++){
+        norm1 += H.at<double>(r, 0) * H.at<double>(r, 0);
+        norm2 += H.at<double>(r, 1) * H.at<double>(r, 1);
+    }
+    norm1 = sqrt(norm1);
+    norm2 = sqrt(norm2);
+    cv::Matx33d R;
+    for (int r = 0; r < 3; r++){
+        R(r, 0) = H.at<double>(r, 0) / norm1;
+        R(r, 1) = H.at<double>(r, 1) / norm2;
+        tvec[r] = H.at<double>(r, 2) * 2 / (norm1 + norm2);
+    }
+    R(0, 2) = R(1, 0) * R(2, 1) - R(2, 0) * R(1, 1);
+    R(1, 2) = R(2, 0) * R(0, 1) - R(0, 0) * R(2, 1);
+    R(2, 2) = R(0, 0) * R(1, 1) - R(1, 0) * R(0, 1);
+    // Rodrigues makes the rotation orthonormal
+    cv::Rodrigues(R, rvec);
+}
+
+// Levenberg-Marquardt iterations (the ones the iterative solver runs) from a starting pose until it stops moving
+static int refineIterations(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const cv::Vec3d& rvec, const cv::Vec3d& tvec){
+    const int maxIterations = 20;
+    cv::Vec3d convergedR = rvec, convergedT = tvec;
+    cv::solvePnPRefineLM(orientations, corners, cameraMatrix, distCoeffs, convergedR, convergedT, cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, maxIterations, FLT_EPSILON));
+    // the solver doesn't report its iterations, find the smallest budget that reaches the same pose
+    for (int n = 0; n < maxIterations; n++){
+        cv::Vec3d r = rvec, t = tvec;
+        if (n > 0){
+            cv::solvePnPRefineLM(orientations, corners, cameraMatrix, distCoeffs, r, t, cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, n, FLT_EPSILON));
+        }
+        double change = 0;
+        for (int k = 0; k < 3; k++){
+            change += abs(r[k] - convergedR[k]) + abs(t[k] - convergedT[k]);
+        }
+        if (change < 1e-9){
+            return n;
+        }
+    }
+    return maxIterations;
+}
+
+int Benchmark::poseSolvers(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // [0] cold iterative solve (the old default), [1] closed-form IPPE_SQUARE, [2] warm started from the previous frame
+    const char* modeNames[3] = {"cold iterative", "IPPE_SQUARE", "warm start"};
+    int64_t ticks[3] = {0, 0, 0};
+    double errors[3] = {0, 0, 0};
+    long long iterations[3] = {0, 0, 0};
+    long long poses = 0, warmPoses = 0;
+
+    DetectionBuffers buffers;
+    vector<MarkerResult> markers;
+    cv::Mat gray;
+    vector<cv::Point2f> corners2f(4);
+    cv::Vec3d rvec, tvec, guessR, guessT;
+
+    while (video.next()){
+        const cv::Mat& frame = video.frame;
+        int i = video.index;
+        bool measuring = video.measuring();
+        MarkerDetection::preprocess(frame, false, 0, 1, gray, buffers);
+        MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, markers, false);
+
+        for (const MarkerResult& res : markers){
+            const vector<cv::Point3f>& orientations = dict.orientations[res.index];
+            for (int c = 0; c < 4; c++){
+                corners2f[c] = res.corners[c];
+            }
+            // the pose trackPose will start from, before it is replaced
+            bool warm = (int)buffers.poses.size() > res.index / 4 && buffers.poses[res.index / 4].sequence == i - 1;
+            if (warm){
+                guessR = buffers.poses[res.index / 4].rvec;
+                guessT = buffers.poses[res.index / 4].tvec;
+            }
+
+            int64_t start = cv::getTickCount();
+            cv::solvePnP(orientations, corners2f, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+            int64_t end = cv::getTickCount();
+            if (measuring){
+                ticks[0] += end - start;
+                errors[0] += MarkerDetection::reprojectionError(orientations, res.corners, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+                homographyPose(orientations, corners2f, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+                iterations[0] += refineIterations(orientations, corners2f, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+            }
+
+            start = cv::getTickCount();
+            MarkerDetection::solvePose(orientations, res.corners, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+            end = cv::getTickCount();
+            if (measuring){
+                ticks[1] += end - start;
+                errors[1] += MarkerDetection::reprojectionError(orientations, res.corners, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+            }
+
+            start = cv::getTickCount();
+            MarkerDetection::trackPose(res.index, i, dict, res.corners, config.cameraMatrix, config.distCoeffs, buffers, rvec, tvec);
+            end = cv::getTickCount();
+            if (measuring){
+                ticks[2] += end - start;
+                errors[2] += MarkerDetection::reprojectionError(orientations, res.corners, config.cameraMatrix, config.distCoeffs, rvec, tvec);
+                if (warm){
+                    iterations[2] += refineIterations(orientations, corners2f, config.cameraMatrix, config.distCoeffs, guessR, guessT);
+                    warmPoses++;
+                }
+                poses++;
+            }
+        }
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMicro = cv::getTickFrequency() / 1e6;
+    poses = max(poses, 1LL);
+    cout << "=========================================" << endl;
+    cout << "[bench] pose solvers on " << config.videoPath << ", " << config.frames << " frames, " << poses << " poses, "
+         << 100.0 * warmPoses / poses << "% started from the previous frame" << endl;
+    for (int m = 0; m < 3; m++){
+        cout << "\t" << modeNames[m] << ": " << ticks[m] / ticksPerMicro / poses << " us per pose, reprojection error "
+             << errors[m] / poses << " px";
+        if (m == 0){
+            cout << ", " << (double)iterations[0] / poses << " iterations from the homography";
+        } else if (m == 1){
+            cout << ", closed form";
+        } else {
+            cout << ", " << (double)iterations[2] / max(warmPoses, 1LL) << " iterations from the previous pose";
+        }
+        cout << endl;
+    }
+    cout << "=========================================" << endl;
+    return 0;
+}
+
+int Benchmark::batchedPoses(const BenchmarkConfig& config){
+    BenchmarkVideo video;
+    if (!video.open(config, config.warmupFrames)){
+        return 1;
+    }
+    const MarkerDict& dict = video.dict;
+
+    // the video shows only a few markers, repeat them so every frame has a room full of furniture
+    const int minMarkers = 32;
+    DetectionBuffers buffers;
+    vector<MarkerResult> detected, markers;
+    cv::Mat gray;
+    vector<cv::Vec3d> singleR, singleT, batchR, batchT;
+    vector<vector<cv::Point2f>> singlePoints;
+    vector<cv::Matx44f> projections;
+    vector<cv::Point2f> batchPoints;
+
+    int64_t singleTicks = 0, batchTicks = 0;
+    double singleError = 0, batchError = 0, pointOffset = 0;
+    long long poses = 0;
+
+    while (video.next()){
+        const cv::Mat& frame = video.frame;
+        bool measuring = video.measuring();
+        MarkerDetection::preprocess(frame, false, 0, 1, gray, buffers);
+        MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, detected, false);
+        markers.clear();
+        while (!detected.empty() && markers.size() < minMarkers){
+            markers.insert(markers.end(), detected.begin(), detected.end());
+        }
+
+        // one marker at a time, like poseEstimation
+        int64_t start = cv::getTickCount();
+        singlePoints.resize(markers.size());
+        singleR.resize(markers.size());
+        singleT.resize(markers.size());
+        for (int m = 0; m < (int)markers.size(); m++){
+            MarkerDetection::solvePose(dict.orientations[markers[m].index], markers[m].corners, config.cameraMatrix, config.distCoeffs, singleR[m], singleT[m]);
+            MarkerDetection::projectCube(singleR[m], singleT[m], config.cameraMatrix, config.distCoeffs, singlePoints[m]);
+        }
+        int64_t middle = cv::getTickCount();
+        // all markers at once
+        MarkerDetection::estimatePoses(dict, markers, config.cameraMatrix, config.distCoeffs, buffers, batchR, batchT);
+        PoseBatch::projectCubes(config.cameraMatrix, config.distCoeffs, buffers.poseBatch, projections, batchPoints);
+        int64_t end = cv::getTickCount();
+
+        if (!measuring){
+            continue;
+        }
+        singleTicks += middle - start;
+        batchTicks += end - middle;
+        for (int m = 0; m < (int)markers.size(); m++){
+            const vector<cv::Point3f>& orientations = dict.orientations[markers[m].index];
+            singleError += MarkerDetection::reprojectionError(orientations, markers[m].corners, config.cameraMatrix, config.distCoeffs, singleR[m], singleT[m]);
+            batchError += MarkerDetection::reprojectionError(orientations, markers[m].corners, config.cameraMatrix, config.distCoeffs, batchR[m], batchT[m]);
+            for (int p = 0; p < 8; p++){
+                pointOffset += cv::norm(batchPoints[m * 8 + p] - singlePoints[m][p]) / 8;
+            }
+        }
+        poses += markers.size();
+    }
+    if (video.failed){
+        return 1;
+    }
+
+    double ticksPerMicro = cv::getTickFrequency() / 1e6;
+    poses = max(poses, 1LL);
+    cout << "=========================================" << endl;
+    cout << "[bench] pose estimation per marker vs batched on " << config.videoPath << ", " << config.frames << " frames, "
+         << (double)poses / config.frames << " markers per frame" << endl;
+    cout << "\tper marker (IPPE_SQUARE, projectPoints): " << singleTicks / ticksPerMicro / poses << " us per marker, reprojection error "
+         << singleError / poses << " px" << endl;
+    cout << "\tbatched (homography, analytic projection): " << batchTicks / ticksPerMicro / poses << " us per marker, reprojection error "
+         << batchError / poses << " px, cube points " << pointOffset / poses << " px from the per marker ones" << endl;
+    cout << "=========================================" << endl;
+    return 0;
+}
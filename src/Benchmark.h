@@ -0,0 +1,150 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include "MarkerDetection.h"
+#include "ObjectRender.h"
+
+using namespace std;
+
+/* Inputs shared by all benchmarks, filled in from the macros in main.cpp */
+struct BenchmarkConfig{
+    string videoPath;
+    string markerPath;
+    string dictionaryCache;
+    string furniturePath;
+    string furnitureCache;
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+    int frames = 300;           // measured frames, the video is rewound when it is shorter
+    int warmupFrames = 30;      // frames run before measuring so every reused buffer has reached its final size
+};
+
+/**
+ * Offline measurements of the detection and render path, run with `./ARchitecture bench <name> [frames]`
+ *
+ * The benchmarks read the video file instead of the webcam, so the numbers can be compared between runs.
+*/
+class Benchmark{
+    public:
+        /**
+         * Runs the benchmark named by the command line
+         *
+         * @param argc The argument count of main
+         * @param argv The arguments of main, argv[1] is "bench"
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int run(int argc, char const *argv[], BenchmarkConfig config);
+
+        /**
+         * Counts the heap allocations per frame of every stage (capture, detection, pose estimation, rendering)
+         *
+         * Runs the whole frame loop on one thread with a hidden window. Once warmed up, the detection, pose
+         * estimation and rendering stages should not allocate anything on their own any more, what is left
+         * comes from inside OpenCV. The video is then run through FramePipeline with its capture thread and
+         * detection workers, and the allocations of the whole process are counted per frame, without rewinding.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int allocations(const BenchmarkConfig& config);
+
+        /**
+         * Measures detectMarker with 1 to N candidate decoding threads (N = number of CPU cores)
+         *
+         * A short clip of the video is held in memory so the capture doesn't skew the timing. Every thread
+         * count is checked to return exactly the markers of the single threaded run.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int decodeScaling(const BenchmarkConfig& config);
+
+        /**
+         * Compares the direct bit sampling (sampleIds) with the warp based decoding (getIds) on every candidate
+         *
+         * Reports how often the two codes and the matched markers agree, and the time per candidate of both.
+         * Run with `./ARchitecture bench sampling [frames] [video]`, e.g. on resources/MarkerMovie_old.MP4.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int samplingComparison(const BenchmarkConfig& config);
+
+        /**
+         * Compares ImageKernels::grayThresholdInv with the cvtColor, threshold and bitwise_not sequence it
+         * replaced, at 720p, 1080p and 4K
+         *
+         * The input is the first video frame scaled to each resolution (random noise without a video). Both run
+         * on a single thread, like every detection worker does, and both outputs are checked to be identical.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int thresholdKernel(const BenchmarkConfig& config);
+
+        /**
+         * Compares the global and the adaptive threshold mode of MarkerDetection::preprocess
+         *
+         * Every frame is detected with both modes (the adaptive one on a single thread and on all cores).
+         * Reports the share of frames with at least one marker, the markers per frame, the time spent
+         * binarizing and the time of the whole detection per frame.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int thresholdModes(const BenchmarkConfig& config);
+
+        /**
+         * Measures the marker detection with the contours searched on pyramid levels 0 to 3
+         *
+         * Reports the time of the contour search alone, of the preprocessing and of the whole detection per
+         * frame, and how far the refined corners are from the corners found at full resolution.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int pyramidSearch(const BenchmarkConfig& config);
+
+        /**
+         * Compares the full frame detection of every frame with both modes of MarkerTracker (regions and optical flow)
+         *
+         * All three run on every frame of the video. Reports the time and markers per frame, how many frames
+         * were scanned completely, the share of the frame area that was searched, how often the markers are
+         * the same as with the full detection and how far their corners are from the detected ones.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int trackingModes(const BenchmarkConfig& config);
+
+        /**
+         * Measures the cost of a PoseFilter update per marker and how much it steadies the cube points
+         *
+         * The frames are timed by the frame rate of the video. The jitter is the mean distance a projected cube
+         * point moves from one frame to the next, with the measured and with the filtered pose.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int poseFiltering(const BenchmarkConfig& config);
+
+        /**
+         * Compares the pose solvers on the detected markers: the cold iterative solvePnP, the closed-form
+         * IPPE_SQUARE of fresh detections and the iterative solver warm started from the previous frame
+         *
+         * Reports the time per pose, the reprojection error and the Levenberg-Marquardt iterations.
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int poseSolvers(const BenchmarkConfig& config);
+
+        /**
+         * Compares solving and projecting one marker at a time with MarkerDetection::estimatePoses and
+         * PoseBatch::projectCubes, on the markers of the video repeated to at least 32 per frame
+         *
+         * @param config The shared inputs
+         * @return the exit code of the program
+        */
+        static int batchedPoses(const BenchmarkConfig& config);
+};
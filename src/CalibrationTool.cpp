@@ -0,0 +1,228 @@
+#include "CalibrationTool.h"
+#include "MarkerDictCache.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+// the solver runs again once this many views have been added since its last solution
+static const int SOLVE_STEP = 5;
+// calibrateCamera needs a few views to say anything about the distortion
+static const int MIN_VIEWS = 3;
+
+// refines the corners of the detected markers and puts them in the order of the unit square, one entry per marker image
+static void orderedCorners(const MarkerDict& dict, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, vector<int>& ids, vector<cv::Point2f>& corners){
+    ids.clear();
+    corners.clear();
+    vector<bool> seen(dict.codes.size() / 4, false);
+    for (const MarkerResult& res : markers){
+        // a marker found twice can't be told apart, leave both out
+        int id = res.index / 4;
+        if (seen[id]){
+            vector<int>::iterator it = find(ids.begin(), ids.end(), id);
+            if (it != ids.end()){
+                int k = it - ids.begin();
+                ids.erase(it);
+                corners.erase(corners.begin() + k * 4, corners.begin() + k * 4 + 4);
+            }
+            continue;
+        }
+        seen[id] = true;
+        ids.push_back(id);
+        corners.resize(corners.size() + 4);
+        cv::Point2f* square = &corners[corners.size() - 4];
+        const vector<cv::Point3f>& orientations = dict.orientations[res.index];
+        for (int c = 0; c < 4; c++){
+            const cv::Point3f& o = orientations[c];
+            int j = o.y < 0.5f ? (o.x < 0.5f ? 0 : 1) : (o.x < 0.5f ? 3 : 2);
+            square[j] = res.corners[c];
+        }
+    }
+    // the frames are searched on level 0, where detectMarker leaves the corners at the whole pixel vertices of the
+    // contour (it only refines corners found on a pyramid level), and the distortion needs them to a fraction of a pixel
+    if (!corners.empty()){
+        cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01);
+        cv::cornerSubPix(frame_grey, corners, cv::Size(5, 5), cv::Size(-1, -1), criteria);
+    }
+}
+
+int CalibrationTool::run(int argc, char const *argv[], CalibrationConfig config){
+    if (argc >= 3){
+        config.videoPath = argv[2];
+    }
+    if (argc >= 4){
+        config.views = max(MIN_VIEWS, atoi(argv[3]));
+    }
+
+    MarkerDict dict = MarkerDictCache::loadOrBuild(config.markerPath, config.dictionaryCache);
+    CalibrationBoard board;
+    int printed = loadBoard(config.boardPath, dict, board);
+    if (printed < config.minMarkers){
+        cout << "[CV] Found " << printed << " markers on the calibration sheet " << config.boardPath << ", exiting" << endl;
+        return 1;
+    }
+    cout << "[CV] " << printed << " markers on the calibration sheet " << config.boardPath << endl;
+
+    cv::VideoCapture cap;
+    if (config.videoPath.empty()){
+        cap.open(0, cv::CAP_FFMPEG);
+    } else {
+        cap.open(config.videoPath, cv::CAP_FFMPEG);
+    }
+    if (!cap.isOpened()){
+        cout << "[CV] Could not open " << (config.videoPath.empty() ? "the webcam" : config.videoPath) << ", exiting" << endl;
+        return 1;
+    }
+    cv::Size imageSize(cap.get(cv::CAP_PROP_FRAME_WIDTH), cap.get(cv::CAP_PROP_FRAME_HEIGHT));
+    cout << "[CV] collecting " << config.views << " views at " << imageSize.width << "x" << imageSize.height << ", one every " << config.viewInterval << " frames" << endl;
+
+    CalibrationState state;
+    thread solver(&CalibrationTool::solveLoop, ref(state), imageSize);
+
+    cv::Mat frame;
+    cv::Mat gray;
+    DetectionBuffers buffers;
+    vector<MarkerResult> markers;
+    vector<cv::Point3f> objectPoints;
+    vector<cv::Point2f> imagePoints;
+    int collected = 0;
+    long long lastView = -config.viewInterval;
+    for (long long i = 0; collected < config.views && cap.read(frame); i++){
+        // the frames right after a view show nearly the same thing, they are not even searched
+        if (i - lastView < config.viewInterval){
+            continue;
+        }
+        MarkerDetection::preprocess(frame, false, 0, 1, gray, buffers);
+        MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, markers, false);
+        int found = collectView(board, dict, gray, markers, objectPoints, imagePoints);
+        if (found < config.minMarkers){
+            continue;
+        }
+        lastView = i;
+        collected++;
+        {
+            lock_guard<mutex> lock(state.stateMutex);
+            state.objectPoints.push_back(objectPoints);
+            state.imagePoints.push_back(imagePoints);
+        }
+        state.wake.notify_one();
+        cout << "[CV] view " << collected << "/" << config.views << ": " << found << " markers in frame " << i << endl;
+    }
+
+    // let the solver finish with every view
+    {
+        lock_guard<mutex> lock(state.stateMutex);
+        state.finished = true;
+    }
+    state.wake.notify_one();
+    solver.join();
+
+    if (state.rms < 0){
+        cout << "[CV] Not enough views of the calibration sheet (" << collected << "), nothing written" << endl;
+        return 1;
+    }
+    if (!CameraCalibration::save(config.calibrationPath, state.intrinsics)){
+        cout << "[CV] Could not write the camera calibration to " << config.calibrationPath << endl;
+        return 1;
+    }
+    cout << "[CV] saved camera calibration from " << state.solvedViews << " views (RMS " << state.rms << " px) to " << config.calibrationPath << endl;
+    return 0;
+}
+
+int CalibrationTool::loadBoard(const string& boardPath, const MarkerDict& dict, CalibrationBoard& board){
+    cv::Mat sheet = cv::imread(boardPath, cv::IMREAD_COLOR);
+    if (sheet.empty()){
+        return 0;
+    }
+
+    // the sheet is searched like any frame, so its layout never has to be written down
+    cv::Mat gray;
+    DetectionBuffers buffers;
+    vector<MarkerResult> markers;
+    MarkerDetection::preprocess(sheet, false, 0, 1, gray, buffers);
+    MarkerDetection::detectMarker(gray, buffers.frame_thresh, 0, dict, 0, 1, buffers, markers, false);
+    vector<int> ids;
+    vector<cv::Point2f> corners;
+    orderedCorners(dict, gray, markers, ids, corners);
+    if (ids.empty()){
+        return 0;
+    }
+
+    // the sheet pixels become marker side lengths, the unit of the poses in the rest of the program
+    double side = 0;
+    for (int i = 0; i < (int)corners.size(); i++){
+        side += cv::norm(corners[i] - corners[i / 4 * 4 + (i + 1) % 4]);
+    }
+    side /= corners.size();
+
+    board.corners.assign(dict.codes.size(), cv::Point3f());
+    board.printed.assign(dict.codes.size() / 4, false);
+    for (int i = 0; i < (int)ids.size(); i++){
+        board.printed[ids[i]] = true;
+        for (int j = 0; j < 4; j++){
+            const cv::Point2f& corner = corners[i * 4 + j];
+            board.corners[ids[i] * 4 + j] = cv::Point3f(corner.x / side, corner.y / side, 0);
+        }
+    }
+    return ids.size();
+}
+
+int CalibrationTool::collectView(const CalibrationBoard& board, const MarkerDict& dict, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, vector<cv::Point3f>& objectPoints, vector<cv::Point2f>& imagePoints){
+    vector<int> ids;
+    vector<cv::Point2f> corners;
+    orderedCorners(dict, frame_grey, markers, ids, corners);
+
+    objectPoints.clear();
+    imagePoints.clear();
+    int found = 0;
+    for (int i = 0; i < (int)ids.size(); i++){
+        if (!board.printed[ids[i]]){
+            continue;
+        }
+        found++;
+        for (int j = 0; j < 4; j++){
+            objectPoints.push_back(board.corners[ids[i] * 4 + j]);
+            imagePoints.push_back(corners[i * 4 + j]);
+        }
+    }
+    return found;
+}
+
+void CalibrationTool::solveLoop(CalibrationState& state, cv::Size imageSize){
+    unique_lock<mutex> lock(state.stateMutex);
+    while (true){
+        state.wake.wait(lock, [&state]{ return state.finished || (int)state.objectPoints.size() >= state.solvedViews + SOLVE_STEP; });
+        int views = state.objectPoints.size();
+        if (views < MIN_VIEWS || views == state.solvedViews){
+            if (state.finished){
+                break;
+            }
+            continue;
+        }
+
+        // solve on a copy, the views keep growing meanwhile
+        vector<vector<cv::Point3f>> objectPoints(state.objectPoints.begin(), state.objectPoints.begin() + views);
+        vector<vector<cv::Point2f>> imagePoints(state.imagePoints.begin(), state.imagePoints.begin() + views);
+        cv::Mat cameraMatrix = state.intrinsics.cameraMatrix.clone();
+        cv::Mat distCoeffs = state.intrinsics.distCoeffs.clone();
+        // every solve after the first starts from the previous one, it only has to move a little
+        int flags = state.rms >= 0 ? cv::CALIB_USE_INTRINSIC_GUESS : 0;
+        lock.unlock();
+
+        vector<cv::Mat> rvecs, tvecs;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        double rms = cv::calibrateCamera(objectPoints, imagePoints, imageSize, cameraMatrix, distCoeffs, rvecs, tvecs, flags);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "[CV] calibration from " << views << " views: RMS " << rms << " px, f " << cameraMatrix.at<double>(0, 0) << "/" << cameraMatrix.at<double>(1, 1)
+             << ", c " << cameraMatrix.at<double>(0, 2) << "/" << cameraMatrix.at<double>(1, 2) << " (" << ms << " ms)" << endl;
+
+        lock.lock();
+        state.rms = rms;
+        state.solvedViews = views;
+        state.intrinsics.cameraMatrix = cameraMatrix;
+        distCoeffs.reshape(1, 1).copyTo(state.intrinsics.distCoeffs);
+        state.intrinsics.imageSize = imageSize;
+    }
+}
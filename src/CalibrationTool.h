@@ -0,0 +1,89 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <condition_variable>
+#include <mutex>
+#include "MarkerDetection.h"
+#include "CameraCalibration.h"
+
+using namespace std;
+
+/* Inputs of the calibration, filled in from the macros in main.cpp */
+struct CalibrationConfig{
+    string videoPath;               // recorded video of the printed sheet, empty reads the webcam
+    string markerPath;
+    string dictionaryCache;
+    string boardPath;               // image of the printed sheet of markers
+    string calibrationPath;         // the calibration file written at the end, the one the app loads
+    int views = 40;                 // views collected before the final solve
+    int viewInterval = 15;          // frames from one collected view to the next, so the views differ
+    int minMarkers = 4;             // markers of the sheet a frame has to show to become a view
+};
+
+/* Marker corners of the printed sheet, in sheet space (z = 0, in marker side lengths) */
+struct CalibrationBoard{
+    vector<cv::Point3f> corners;    // 4 per marker image (dictionary index / 4), in the order (0,0) (1,0) (1,1) (0,1) of the unit square
+    vector<bool> printed;           // whether the marker image is on the sheet
+};
+
+/* The views collected so far and the latest solution, shared with the solver thread */
+struct CalibrationState{
+    mutex stateMutex;
+    condition_variable wake;
+    vector<vector<cv::Point3f>> objectPoints;   // one list of sheet corners per view
+    vector<vector<cv::Point2f>> imagePoints;    // the same corners in the frame
+    bool finished = false;                      // no more views are coming
+    int solvedViews = 0;                        // the views the latest solution was made from
+    double rms = -1;                            // reprojection error of the latest solution in pixels, -1 if there is none
+    CameraIntrinsics intrinsics;
+};
+
+/**
+ * Calibrates the camera on the printed sheet of markers (resources/markers_all.png), run with
+ * `./ARchitecture calibrate [video] [views]`
+ *
+ * The sheet itself is the calibration target: its layout is found by running the marker detector on the
+ * sheet image, so any arrangement of the dictionary markers works. Every frame then goes through the same
+ * contour search and decoding as the app, and each marker of the sheet found in it gives 4 point
+ * correspondences. cv::calibrateCamera is rerun on a background thread whenever a few more views have been
+ * collected, starting from the previous solution, while the frames keep coming. Nothing is shown, so it
+ * runs headless on a recorded video as well as on the webcam.
+*/
+class CalibrationTool{
+    public:
+        /**
+         * Collects the views, solves the calibration and writes it to config.calibrationPath
+         *
+         * @param argc The argument count of main
+         * @param argv The arguments of main, argv[1] is "calibrate"
+         * @param config The inputs
+         * @return the exit code of the program
+        */
+        static int run(int argc, char const *argv[], CalibrationConfig config);
+
+        /**
+         * Finds the markers on the sheet image and builds the board from them
+         *
+         * @param boardPath The image of the sheet
+         * @param dict The marker dictionary
+         * @param board Receives the corners of every marker on the sheet
+         * @return the number of markers found on the sheet, 0 if the image can't be read
+        */
+        static int loadBoard(const string& boardPath, const MarkerDict& dict, CalibrationBoard& board);
+
+        /**
+         * Pairs the corners of the detected sheet markers with their position on the sheet
+         *
+         * @param board The sheet
+         * @param dict The marker dictionary
+         * @param frame_grey The greyscale frame, the corners are refined to subpixel accuracy on it
+         * @param markers The markers detected in the frame
+         * @param objectPoints Receives the sheet corners
+         * @param imagePoints Receives the frame corners
+         * @return the number of sheet markers in the view
+        */
+        static int collectView(const CalibrationBoard& board, const MarkerDict& dict, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, vector<cv::Point3f>& objectPoints, vector<cv::Point2f>& imagePoints);
+
+    private:
+        // reruns the calibration whenever enough new views have arrived, until finished is set
+        static void solveLoop(CalibrationState& state, cv::Size imageSize);
+};
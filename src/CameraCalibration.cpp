@@ -0,0 +1,143 @@
+#include "CameraCalibration.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const uint32_t REMAP_VERSION = 1;
+
+struct RemapHeader{
+    char magic[4];
+    uint32_t version;
+    uint64_t calibrationHash;
+    int32_t width;
+    int32_t height;
+};
+
+// FNV-1a over the calibration values, the table is rebuilt when any of them changes
+static uint64_t hashIntrinsics(const CameraIntrinsics& intrinsics, cv::Size frameSize){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto add = [&hash](const void* data, size_t size){
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++){
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    add(&REMAP_VERSION, sizeof(REMAP_VERSION));
+    add(&frameSize.width, sizeof(frameSize.width));
+    add(&frameSize.height, sizeof(frameSize.height));
+    for (const cv::Mat* m : {&intrinsics.cameraMatrix, &intrinsics.distCoeffs}){
+        for (int i = 0; i < (int)m->total(); i++){
+            double value = m->at<double>(i);
+            add(&value, sizeof(value));
+        }
+    }
+    return hash;
+}
+
+bool CameraCalibration::load(const string& path, CameraIntrinsics& intrinsics){
+    cv::FileStorage file;
+    if (!filesystem::exists(path) || !file.open(path, cv::FileStorage::READ)){
+        return false;
+    }
+    cv::Mat cameraMatrix, distCoeffs;
+    file["camera_matrix"] >> cameraMatrix;
+    file["distortion_coefficients"] >> distCoeffs;
+    if (cameraMatrix.rows != 3 || cameraMatrix.cols != 3){
+        return false;
+    }
+
+    // the rest of the program reads them as doubles
+    cameraMatrix.convertTo(intrinsics.cameraMatrix, CV_64F);
+    if (distCoeffs.empty()){
+        intrinsics.distCoeffs.release();
+    } else {
+        distCoeffs.reshape(1, 1).convertTo(intrinsics.distCoeffs, CV_64F);
+    }
+    int width = 0, height = 0;
+    file["image_width"] >> width;
+    file["image_height"] >> height;
+    intrinsics.imageSize = cv::Size(width, height);
+    return true;
+}
+
+bool CameraCalibration::save(const string& path, const CameraIntrinsics& intrinsics){
+    cv::FileStorage file;
+    if (!file.open(path, cv::FileStorage::WRITE)){
+        return false;
+    }
+    file << "image_width" << intrinsics.imageSize.width;
+    file << "image_height" << intrinsics.imageSize.height;
+    file << "camera_matrix" << intrinsics.cameraMatrix;
+    file << "distortion_coefficients" << intrinsics.distCoeffs;
+    return true;
+}
+
+CameraIntrinsics CameraCalibration::scaledTo(const CameraIntrinsics& intrinsics, cv::Size frameSize){
+    CameraIntrinsics scaled = intrinsics;
+    scaled.cameraMatrix = intrinsics.cameraMatrix.clone();
+    if (intrinsics.imageSize.empty() || intrinsics.imageSize == frameSize){
+        return scaled;
+    }
+    // the distortion coefficients work on normalized coordinates, only the pixel scale changes
+    double sx = (double)frameSize.width / intrinsics.imageSize.width;
+    double sy = (double)frameSize.height / intrinsics.imageSize.height;
+    scaled.cameraMatrix.at<double>(0, 0) *= sx;
+    scaled.cameraMatrix.at<double>(0, 1) *= sx;
+    scaled.cameraMatrix.at<double>(0, 2) *= sx;
+    scaled.cameraMatrix.at<double>(1, 1) *= sy;
+    scaled.cameraMatrix.at<double>(1, 2) *= sy;
+    scaled.imageSize = frameSize;
+    return scaled;
+}
+
+void CameraCalibration::loadOrBuildRemap(const string& calibrationPath, const CameraIntrinsics& intrinsics, cv::Size frameSize, cv::Mat& map1, cv::Mat& map2){
+    string cachePath = calibrationPath + "." + to_string(frameSize.width) + "x" + to_string(frameSize.height) + ".remap";
+    uint64_t calibrationHash = hashIntrinsics(intrinsics, frameSize);
+    map1.create(frameSize, CV_16SC2);
+    map2.create(frameSize, CV_16UC1);
+    size_t size1 = map1.total() * map1.elemSize();
+    size_t size2 = map2.total() * map2.elemSize();
+
+    {
+        ifstream in(cachePath, ios::binary);
+        RemapHeader header;
+        if (in.read((char*)&header, sizeof(header)) && memcmp(header.magic, "ARRM", 4) == 0 && header.version == REMAP_VERSION
+            && header.calibrationHash == calibrationHash && header.width == frameSize.width && header.height == frameSize.height
+            && in.read((char*)map1.data, size1) && in.read((char*)map2.data, size2)){
+            cout << "[CV] loaded undistortion table from " << cachePath << endl;
+            return;
+        }
+    }
+
+    cv::initUndistortRectifyMap(intrinsics.cameraMatrix, intrinsics.distCoeffs, cv::Mat(), intrinsics.cameraMatrix, frameSize, CV_16SC2, map1, map2);
+
+    // write next to the cache and swap it in, so a crash never leaves a half written table behind
+    RemapHeader header;
+    memcpy(header.magic, "ARRM", 4);
+    header.version = REMAP_VERSION;
+    header.calibrationHash = calibrationHash;
+    header.width = frameSize.width;
+    header.height = frameSize.height;
+    string tmpPath = cachePath + ".tmp";
+    bool written;
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)map1.data, size1);
+        out.write((const char*)map2.data, size2);
+        written = (bool)out;
+    }
+    error_code error;
+    if (written){
+        filesystem::rename(tmpPath, cachePath, error);
+    }
+    if (written && !error){
+        cout << "[CV] saved undistortion table to " << cachePath << endl;
+    } else {
+        cout << "[CV] could not save undistortion table to " << cachePath << endl;
+    }
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+/* How the lens distortion is taken out, see PipelineConfig::undistort */
+enum UndistortMode{
+    UNDISTORT_NONE = 0,         // the distortion coefficients are handed to every pose solve and projection
+    UNDISTORT_CORNERS = 1,      // only the marker corners are undistorted, all at once per frame
+    UNDISTORT_FRAME = 2         // every frame is remapped before detection, with the cached remap table
+};
+
+struct CameraIntrinsics{
+    cv::Mat cameraMatrix;       // 3x3, CV_64F
+    cv::Mat distCoeffs;         // 1xN, CV_64F, may be empty
+    cv::Size imageSize;         // the resolution the camera was calibrated at, empty if the file doesn't say
+};
+
+/**
+ * Loads the camera calibration and prepares the undistortion
+ *
+ * The calibration is a YAML or JSON file in the format of the OpenCV calibration sample (the format is
+ * picked by the extension):
+ *
+ *      camera_matrix               3x3 matrix
+ *      distortion_coefficients     1x4, 1x5, 1x8 ... matrix
+ *      image_width, image_height   the resolution it was made at, optional
+ *
+ * The remap table of UNDISTORT_FRAME takes a while to compute at high resolutions. It is kept in
+ * fixed point (CV_16SC2 + CV_16UC1, what cv::remap reads fastest) and cached next to the calibration
+ * file, one file per resolution, rebuilt whenever the calibration changes.
+*/
+class CameraCalibration{
+    public:
+        /**
+         * Reads a calibration file
+         *
+         * @param path The path of the .yml, .yaml or .json file
+         * @param intrinsics Receives the calibration
+         * @return false if the file can't be read or has no camera matrix
+        */
+        static bool load(const string& path, CameraIntrinsics& intrinsics);
+
+        /**
+         * Writes a calibration file that load reads back
+         *
+         * @param path The path of the .yml, .yaml or .json file
+         * @param intrinsics The calibration
+         * @return false if the file can't be written
+        */
+        static bool save(const string& path, const CameraIntrinsics& intrinsics);
+
+        /**
+         * Adapts a calibration to another resolution of the same camera
+         *
+         * @param intrinsics The calibration
+         * @param frameSize The resolution of the frames
+         * @return the calibration with the focal lengths and principal point scaled, unchanged if the calibration has no size
+        */
+        static CameraIntrinsics scaledTo(const CameraIntrinsics& intrinsics, cv::Size frameSize);
+
+        /**
+         * Loads the fixed point remap table of a resolution from its cache file, and computes and saves it
+         * first if it is missing or was made with another calibration
+         *
+         * @param calibrationPath The path of the calibration file, the cache file is named after it
+         * @param intrinsics The calibration, already scaled to frameSize
+         * @param frameSize The resolution of the frames
+         * @param map1 Receives the integer part of the table (CV_16SC2)
+         * @param map2 Receives the interpolation part of the table (CV_16UC1)
+        */
+        static void loadOrBuildRemap(const string& calibrationPath, const CameraIntrinsics& intrinsics, cv::Size frameSize, cv::Mat& map1, cv::Mat& map2);
+};
@@ -0,0 +1,237 @@
+#include "FramePipeline.h"
+#include "FrameStats.h"
+#include <chrono>
+
+using namespace std;
+
+// spin for a few rounds before yielding, and sleep once a stage has been idle for a while
+static void backoff(int& spins){
+    spins++;
+    if (spins < 16){
+        return;
+    } else if (spins < 64){
+        this_thread::yield();
+    } else {
+        this_thread::sleep_for(chrono::microseconds(200));
+    }
+}
+
+// slots of the reorder ring, every frame that can be in flight between capture and render fits without waiting
+static size_t pendingSlots(const PipelineConfig& config){
+    size_t needed = 2 * max(config.queueDepth, 1) + 2 * max(config.detectionWorkers, 1);
+    size_t slots = 2;
+    while (slots < needed){
+        slots *= 2;
+    }
+    return slots;
+}
+
+FramePipeline::FramePipeline(cv::VideoCapture& cap, const MarkerDict& dict, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const PipelineConfig& config)
+    : cap(cap), dict(dict), cameraMatrix(cameraMatrix), distCoeffs(distCoeffs), config(config),
+      captureQueue(max(config.queueDepth, 1)), resultQueue(max(config.queueDepth, 1) + max(config.detectionWorkers, 1)),
+      recycleQueue(2 * max(config.queueDepth, 1) + max(config.detectionWorkers, 1) + 2), tracker(config.keyframeInterval, config.opticalFlow),
+      running(false), captureDone(false), activeWorkers(0), pending(pendingSlots(config)), nextSequence(0){
+}
+
+FramePipeline::~FramePipeline(){
+    stop();
+}
+
+void FramePipeline::start(){
+    running = true;
+    captureDone = false;
+    activeWorkers = config.detectionWorkers;
+
+    captureThread = thread(&FramePipeline::captureLoop, this);
+    for (int i = 0; i < config.detectionWorkers; i++){
+        workerThreads.push_back(thread(&FramePipeline::detectionLoop, this));
+    }
+}
+
+void FramePipeline::stop(){
+    running = false;
+    if (captureThread.joinable()){
+        captureThread.join();
+    }
+    for (thread& worker : workerThreads){
+        if (worker.joinable()){
+            worker.join();
+        }
+    }
+    workerThreads.clear();
+}
+
+void FramePipeline::captureLoop(){
+    int frame_width = cap.get(cv::CAP_PROP_FRAME_WIDTH);
+    int frame_height = cap.get(cv::CAP_PROP_FRAME_HEIGHT);
+    long long sequence = 0;
+    while (running){
+        // read into a frame the render thread is done with, its buffer is reused when the size matches
+        FrameResult job;
+        recycleQueue.tryPop(job);
+        if (!cap.read(job.frame)){
+            break;
+        }
+        // some backends hand out raw YUYV frames as a single row of bytes
+        if (job.frame.rows == 1 && job.frame.total() * job.frame.elemSize() == (size_t)frame_width * frame_height * 2){
+            job.frame = job.frame.reshape(2, frame_height);
+        }
+        job.sequence = sequence++;
+        job.captureTime = FramePipeline::now();
+
+        // the frame needs a free slot in the reorder ring of nextResult, taken once it is that close to the render thread
+        int spins = 0;
+        while (running && (job.sequence - nextSequence >= (long long)pending.size() || !captureQueue.tryPush(job))){
+            backoff(spins);
+        }
+    }
+    captureDone = true;
+}
+
+void FramePipeline::detectionLoop(){
+    FrameResult job;
+    DetectionBuffers buffers;
+    int spins = 0;
+    while (running){
+        // the capture thread is done once the flag is set, so an empty pop after that means we are finished
+        bool finished = captureDone;
+        if (!captureQueue.tryPop(job)){
+            if (finished){
+                break;
+            }
+            backoff(spins);
+            continue;
+        }
+        spins = 0;
+
+        processFrame(job, buffers);
+        while (running && !resultQueue.tryPush(job)){
+            backoff(spins);
+        }
+        spins = 0;
+    }
+    activeWorkers--;
+}
+
+void FramePipeline::processFrame(FrameResult& result, DetectionBuffers& buffers){
+    // the remapped frame replaces the captured one, so the markers are found and drawn on the undistorted image
+    if (config.undistort == UNDISTORT_FRAME){
+        const cv::Mat* source = &result.frame;
+        if (result.frame.channels() == 2){
+            cv::cvtColor(result.frame, buffers.frame_bgr, cv::COLOR_YUV2BGR_YUYV);
+            FrameStats::countCopy(buffers.frame_bgr);
+            source = &buffers.frame_bgr;
+        }
+        cv::remap(*source, buffers.frame_undistorted, config.undistortMap1, config.undistortMap2, cv::INTER_LINEAR);
+        FrameStats::countCopy(buffers.frame_undistorted);
+        swap(result.frame, buffers.frame_undistorted);
+    }
+
+    // between two full scans the known markers are followed with optical flow or only their surroundings are searched
+    bool fullScan;
+    bool followed = false;
+    if (tracker.usesOpticalFlow()){
+        MarkerDetection::toGray(result.frame, result.gray);
+        followed = tracker.follow(result.sequence, result.gray, buffers, result.markers);
+        fullScan = !followed;
+    } else {
+        fullScan = tracker.plan(result.sequence, result.frame.size(), buffers.regions);
+    }
+
+    if (fullScan){
+        // convert once, the contours are found in the binary image and the markers decoded from the greyscale one.
+        // The optical flow has converted the frame already, then the greyscale image is only thresholded
+        int level = MarkerDetection::searchLevel(config.minMarkerSize);
+        const cv::Mat& source = tracker.usesOpticalFlow() ? result.gray : result.frame;
+        MarkerDetection::preprocess(source, config.adaptiveThreshold, level, config.thresholdThreads, result.gray, buffers);
+
+        // detect all markers in the frame
+        MarkerDetection::detectMarker(result.gray, buffers.frame_thresh, level, dict, config.errorThreshold, config.decodeThreads, buffers, result.markers, config.debug);
+    } else if (!followed){
+        MarkerDetection::preprocessRegions(result.frame, config.adaptiveThreshold, config.thresholdThreads, buffers.regions, result.gray, buffers);
+        MarkerDetection::findContourAndSquareInRegions(buffers.frame_thresh, buffers.regions, buffers);
+        MarkerDetection::decodeCandidates(result.gray, dict, config.errorThreshold, config.decodeThreads, buffers, result.markers, config.debug);
+    }
+    tracker.update(result.sequence, fullScan, result.gray, result.markers, buffers);
+
+    // without distortion coefficients the poses are solved on undistorted corners, or the frame was undistorted already
+    const vector<MarkerResult>* markers = &result.markers;
+    const cv::Mat& poseDistCoeffs = config.undistort == UNDISTORT_NONE ? distCoeffs : noDistortion;
+    if (config.undistort == UNDISTORT_CORNERS){
+        MarkerDetection::undistortCorners(result.markers, cameraMatrix, distCoeffs, buffers, buffers.undistorted);
+        markers = &buffers.undistorted;
+    }
+
+    // estimate the pose of every detected marker, all at once or starting from the pose this worker found for it in a recent frame
+    if (config.batchPoses){
+        MarkerDetection::estimatePoses(dict, *markers, cameraMatrix, poseDistCoeffs, buffers, result.rvecs, result.tvecs);
+    } else {
+        result.rvecs.resize(markers->size());
+        result.tvecs.resize(markers->size());
+        for (int i = 0; i < (int)markers->size(); i++){
+            const MarkerResult& res = (*markers)[i];
+            MarkerDetection::trackPose(res.index, result.sequence, dict, res.corners, cameraMatrix, poseDistCoeffs, buffers, result.rvecs[i], result.tvecs[i]);
+        }
+    }
+    if (config.projectPoses){
+        if (!config.batchPoses){
+            PoseBatch::load(result.rvecs, result.tvecs, buffers.poseBatch);
+        }
+        // the cube is drawn on the captured frame, so it has to be distorted again unless the frame was remapped
+        PoseBatch::projectCubes(cameraMatrix, projectionDistCoeffs(), buffers.poseBatch, result.projections, result.projectedPoints);
+    }
+}
+
+const cv::Mat& FramePipeline::projectionDistCoeffs() const{
+    return config.undistort == UNDISTORT_FRAME ? noDistortion : distCoeffs;
+}
+
+double FramePipeline::now(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool FramePipeline::nextResult(FrameResult& result){
+    int spins = 0;
+    while (running){
+        // without workers the detection runs here, on the calling thread
+        if (config.detectionWorkers == 0){
+            bool finished = captureDone;
+            if (captureQueue.tryPop(result)){
+                processFrame(result, inlineBuffers);
+                nextSequence++;
+                return true;
+            } else if (finished){
+                return false;
+            }
+            backoff(spins);
+            continue;
+        }
+
+        // the workers finish frames out of order, hold back the ones that arrive early
+        FrameResult& slot = pending[nextSequence % pending.size()];
+        if (slot.sequence == nextSequence){
+            result = std::move(slot);
+            slot.sequence = -1;
+            nextSequence++;
+            return true;
+        }
+
+        // every worker has left once the counter hits zero, so an empty pop after that means we are finished
+        bool finished = activeWorkers == 0;
+        FrameResult incoming;
+        if (resultQueue.tryPop(incoming)){
+            spins = 0;
+            pending[incoming.sequence % pending.size()] = std::move(incoming);
+            continue;
+        } else if (finished){
+            return false;
+        }
+        backoff(spins);
+    }
+    return false;
+}
+
+void FramePipeline::recycle(FrameResult& result){
+    // when the pool is full the result is simply released
+    recycleQueue.tryPush(result);
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include "MarkerDetection.h"
+#include "MarkerTracker.h"
+#include "CameraCalibration.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+/**
+ * Bounded lock-free multi-producer/multi-consumer queue
+ *
+ * Each slot carries a sequence number that tells producers and consumers whether the slot is free
+ * or filled for their current lap around the ring, so pushing and popping only needs a single
+ * compare-and-swap on the shared position counters and never takes a lock.
+ * The capacity is rounded up to the next power of two.
+*/
+template <typename T>
+class BoundedQueue{
+    public:
+        explicit BoundedQueue(size_t capacity){
+            size_t size = 2;
+            while (size < capacity){
+                size *= 2;
+            }
+            mask = size - 1;
+            cells.reset(new Cell[size]);
+            for (size_t i = 0; i < size; i++){
+                cells[i].sequence.store(i, memory_order_relaxed);
+            }
+            enqueuePos.store(0, memory_order_relaxed);
+            dequeuePos.store(0, memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /**
+         * Moves the item into the queue
+         *
+         * @param item The item to push, left in a moved-from state on success
+         * @return false if the queue is full
+        */
+        bool tryPush(T& item){
+            Cell* cell;
+            size_t pos = enqueuePos.load(memory_order_relaxed);
+            while (true){
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0){
+                    if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)){
+                        break;
+                    }
+                } else if (diff < 0){
+                    return false;
+                } else {
+                    pos = enqueuePos.load(memory_order_relaxed);
+                }
+            }
+            cell->data = std::move(item);
+            cell->sequence.store(pos + 1, memory_order_release);
+            return true;
+        }
+
+        /**
+         * Moves the oldest item out of the queue
+         *
+         * @param item Receives the popped item
+         * @return false if the queue is empty
+        */
+        bool tryPop(T& item){
+            Cell* cell;
+            size_t pos = dequeuePos.load(memory_order_relaxed);
+            while (true){
+                cell = &cells[pos & mask];
+                size_t seq = cell->sequence.load(memory_order_acquire);
+                intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (diff == 0){
+                    if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)){
+                        break;
+                    }
+                } else if (diff < 0){
+                    return false;
+                } else {
+                    pos = dequeuePos.load(memory_order_relaxed);
+                }
+            }
+            item = std::move(cell->data);
+            cell->sequence.store(pos + mask + 1, memory_order_release);
+            return true;
+        }
+
+    private:
+        struct Cell{
+            atomic<size_t> sequence;
+            T data;
+        };
+
+        unique_ptr<Cell[]> cells;
+        size_t mask;
+        // keep the two position counters on separate cache lines so producers and consumers don't contend
+        alignas(64) atomic<size_t> enqueuePos;
+        alignas(64) atomic<size_t> dequeuePos;
+};
+
+/**
+ * A frame together with everything the render thread needs to draw it
+ *
+ * The capture thread fills in sequence and frame, the detection stage adds the markers and their
+ * projected points. Results handed back with FramePipeline::recycle() are reused for later frames,
+ * so their image and vectors keep their memory across frames.
+*/
+struct FrameResult{
+    long long sequence = -1;
+    cv::Mat frame;                                  // BGR, or YUYV in the YUV capture mode
+    cv::Mat gray;                                   // the greyscale image the detection ran on
+    double captureTime = 0;                         // steady clock time in seconds when the frame was read
+    vector<MarkerResult> markers;
+    vector<cv::Vec3d> rvecs;                        // pose of every marker as measured in this frame
+    vector<cv::Vec3d> tvecs;
+    vector<cv::Point2f> projectedPoints;            // projected cube points, 8 per marker one marker after the other
+    vector<cv::Matx44f> projections;                // marker space to pixels of every marker, see PoseBatch::projectVertices
+};
+
+struct PipelineConfig{
+    int queueDepth = 4;         // frames buffered between two stages, lower = less latency, higher = smoother throughput
+    int detectionWorkers = 2;   // 0 runs detection on the thread calling nextResult()
+    int decodeThreads = 1;      // threads decoding the candidates of a single frame
+    bool adaptiveThreshold = false; // binarize against the local mean instead of a fixed threshold, for uneven lighting
+    int thresholdThreads = -1;  // stripes of a frame binarized in parallel in adaptive mode, -1 leaves the split to OpenCV's thread pool
+    int minMarkerSize = 0;      // side length in pixels of the smallest marker to detect, larger values search on a smaller pyramid level
+    int keyframeInterval = 0;   // frames from one full frame scan to the next, the frames in between only search around known markers (0 = off)
+    bool opticalFlow = false;   // follow the markers with optical flow between the full scans instead of searching around them
+    bool projectPoses = true;   // project the cube points on the workers, off when the render thread filters the poses first
+    bool batchPoses = false;    // solve all poses of a frame at once in closed form instead of refining each marker from its last pose
+    int undistort = UNDISTORT_NONE; // how the lens distortion is taken out, see UndistortMode
+    cv::Mat undistortMap1;      // fixed point remap table of the UNDISTORT_FRAME mode, see CameraCalibration::loadOrBuildRemap
+    cv::Mat undistortMap2;
+    int errorThreshold = 0;
+    bool debug = false;
+};
+
+
+/**
+ * Runs capture, marker detection and pose estimation on separate threads
+ *
+ * A capture thread reads frames into a bounded queue, a pool of detection workers runs
+ * detectMarker and the pose estimation on them and pushes the results into a second bounded queue.
+ * The render thread (the one owning the GLFW context) pulls the results back in capture order
+ * with nextResult(). When both queues are full the capture thread waits, so the queue depth
+ * bounds the latency between capturing a frame and drawing it. The capture thread also waits while
+ * a full reorder ring of frames is ahead of the render thread, so a stalled worker cannot let the
+ * frames that overtook it pile up.
+*/
+class FramePipeline{
+    public:
+        FramePipeline(cv::VideoCapture& cap, const MarkerDict& dict, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const PipelineConfig& config);
+        ~FramePipeline();
+
+        /* Starts the capture thread and the detection workers */
+        void start();
+
+        /* Stops and joins all threads, frames still in flight are dropped */
+        void stop();
+
+        /**
+         * Waits for the next processed frame, in the order it was captured
+         *
+         * @param result Receives the processed frame
+         * @return false once the capture has ended and every frame has been handed out
+        */
+        bool nextResult(FrameResult& result);
+
+        /**
+         * Hands a result that has been drawn back to the pipeline so its buffers can be reused
+         *
+         * @param result The result to reuse, left in a moved-from state
+        */
+        void recycle(FrameResult& result);
+
+        /* The steady clock time in seconds, the clock of FrameResult::captureTime */
+        static double now();
+
+        /* The distortion coefficients to project points onto FrameResult::frame with, none once the frames are remapped */
+        const cv::Mat& projectionDistCoeffs() const;
+
+    private:
+        void captureLoop();
+        void detectionLoop();
+        void processFrame(FrameResult& result, DetectionBuffers& buffers);
+
+        cv::VideoCapture& cap;
+        const MarkerDict& dict;
+        cv::Mat cameraMatrix;
+        cv::Mat distCoeffs;
+        cv::Mat noDistortion;       // stays empty, for the solves and projections that need no distortion
+        PipelineConfig config;
+
+        BoundedQueue<FrameResult> captureQueue;
+        BoundedQueue<FrameResult> resultQueue;
+        BoundedQueue<FrameResult> recycleQueue;
+        // where the markers were in the newest finished frame, shared by the workers
+        MarkerTracker tracker;
+
+        thread captureThread;
+        vector<thread> workerThreads;
+        atomic<bool> running;
+        atomic<bool> captureDone;
+        atomic<int> activeWorkers;
+
+        // results that arrived ahead of the next expected frame, in slot sequence % pending.size() (only touched by the render thread)
+        vector<FrameResult> pending;
+        // the sequence nextResult hands out next, the capture thread waits while pending.size() frames are ahead of it
+        atomic<long long> nextSequence;
+        // detection scratch memory when the detection runs on the render thread
+        DetectionBuffers inlineBuffers;
+};
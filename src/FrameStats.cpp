@@ -0,0 +1,86 @@
+#include "FrameStats.h"
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+#ifdef COUNT_ALLOCATIONS
+
+/* ======================================== GLOBAL OPERATOR NEW ======================================== */
+// every std::vector, std::map and std::string allocation of the program passes through here
+
+void* operator new(size_t size){
+    FrameStats::countAllocation(size);
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (!ptr){
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size){
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept{
+    FrameStats::countAllocation(size);
+    return malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept{
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* ptr) noexcept{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept{
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept{
+    free(ptr);
+}
+
+/* ======================================== cv::Mat ALLOCATOR ======================================== */
+// cv::Mat buffers are allocated with cv::fastMalloc and never reach operator new, so the default
+// Mat allocator is wrapped to count them as well. The actual work is left to OpenCV's own allocator.
+class CountingMatAllocator : public cv::MatAllocator{
+    public:
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override{
+            // a Mat wrapping user memory doesn't allocate its pixels
+            if (!data){
+                size_t size = CV_ELEM_SIZE(type);
+                for (int i = 0; i < dims; i++){
+                    size *= sizes[i];
+                }
+                FrameStats::countAllocation(size);
+            }
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+        }
+
+        bool allocate(cv::UMatData* data, cv::AccessFlag accessflags, cv::UMatUsageFlags usageFlags) const override{
+            return cv::Mat::getStdAllocator()->allocate(data, accessflags, usageFlags);
+        }
+
+        void deallocate(cv::UMatData* data) const override{
+            cv::Mat::getStdAllocator()->deallocate(data);
+        }
+};
+
+void FrameStats::installCountingAllocator(){
+    static CountingMatAllocator allocator;
+    cv::Mat::setDefaultAllocator(&allocator);
+}
+
+#else
+
+void FrameStats::installCountingAllocator(){
+}
+
+#endif
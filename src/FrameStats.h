@@ -0,0 +1,65 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <atomic>
+
+using namespace std;
+
+/**
+ * Process wide counters used to measure the per-frame cost of the pipeline
+ *
+ * Every buffer the pixels of a frame are copied or converted into is counted: explicit copies go through
+ * FrameStats::copy, the color conversions (including the greyscale image of the detection), the undistortion
+ * remap and the upload into the pixel buffer call countCopy on their output. bytesCopied / frames is the
+ * average number of bytes written that way per frame. The binary image and the search pyramid are made
+ * from the greyscale image and are not counted.
+ * 
+ * Heap allocations are only counted in builds with COUNT_ALLOCATIONS defined (cmake -DCOUNT_ALLOCATIONS=ON
+ * or make COUNT_ALLOCATIONS=1), which replaces the global operator new (FrameStats.cpp) and, once
+ * installCountingAllocator() has been called, the allocator behind every cv::Mat buffer. Counting costs
+ * two atomic adds per allocation, so the normal build leaves the allocators alone.
+ * Scratch memory OpenCV takes internally through cv::fastMalloc/AutoBuffer is not counted.
+*/
+struct FrameStats{
+#ifdef COUNT_ALLOCATIONS
+    static constexpr bool countingAllocations = true;
+#else
+    static constexpr bool countingAllocations = false;
+#endif
+
+    inline static atomic<unsigned long long> bytesCopied{0};
+    inline static atomic<unsigned long long> frames{0};
+    inline static atomic<unsigned long long> allocations{0};
+    inline static atomic<unsigned long long> bytesAllocated{0};
+
+    /* Counts a single heap allocation */
+    static void countAllocation(size_t size){
+        allocations.fetch_add(1, memory_order_relaxed);
+        bytesAllocated.fetch_add(size, memory_order_relaxed);
+    }
+
+    /* Makes every cv::Mat allocated from now on count towards the allocation counters, does nothing without COUNT_ALLOCATIONS */
+    static void installCountingAllocator();
+
+    /* Counts the bytes of an image copy or conversion that happened outside of FrameStats::copy */
+    static void countCopy(const cv::Mat& image){
+        bytesCopied.fetch_add(image.total() * image.elemSize(), memory_order_relaxed);
+    }
+
+    /* Deep copies the image into destination, whose buffer is reused when the size matches, and counts the copied bytes */
+    static void copy(const cv::Mat& image, cv::Mat& destination){
+        image.copyTo(destination);
+        countCopy(destination);
+    }
+
+    /* Average number of copied bytes per frame so far */
+    static double bytesCopiedPerFrame(){
+        unsigned long long count = frames.load();
+        return count == 0 ? 0.0 : (double)bytesCopied.load() / count;
+    }
+
+    /* Average number of heap allocations per frame so far, including the ones made at startup */
+    static double allocationsPerFrame(){
+        unsigned long long count = frames.load();
+        return count == 0 ? 0.0 : (double)allocations.load() / count;
+    }
+};
@@ -0,0 +1,324 @@
+#include "FurnitureModels.h"
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+static const uint32_t CACHE_VERSION = 1;
+static const int NAME_SIZE = 32;
+
+struct CacheHeader{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t modelCount;
+    uint32_t vertexCount;
+};
+
+struct CacheModel{
+    char name[NAME_SIZE];
+    uint32_t first;
+    uint32_t count;
+};
+
+typedef array<GLfloat, 3> PaletteColor;
+
+// FNV-1a, good enough to notice that the text file changed
+static void hashBytes(uint64_t& hash, const void* data, size_t size){
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/* ======================================== PARSING ======================================== */
+
+// x y h of the file to marker space, where the height runs along -z
+static bool readPoint(istringstream& in, cv::Point3f& point){
+    float x, y, h;
+    if (!(in >> x >> y >> h)){
+        return false;
+    }
+    point = cv::Point3f(x, y, -h);
+    return true;
+}
+
+// a palette index, or -1 for "-"
+static bool readColor(istringstream& in, const map<int, PaletteColor>& palette, int& color){
+    string token;
+    if (!(in >> token)){
+        return false;
+    }
+    if (token == "-"){
+        color = -1;
+        return true;
+    }
+    char* end;
+    color = strtol(token.c_str(), &end, 10);
+    return *end == '\0' && palette.count(color);
+}
+
+static void addFace(MeshBuilder& mesh, const map<int, PaletteColor>& palette, int color, const vector<cv::Point3f>& corners){
+    if (color < 0){
+        return;
+    }
+    const PaletteColor& rgb = palette.at(color);
+    mesh.begin(corners.size() == 3 ? GL_TRIANGLES : corners.size() == 4 ? GL_QUADS : GL_POLYGON);
+    mesh.color(rgb[0], rgb[1], rgb[2]);
+    for (const cv::Point3f& corner : corners){
+        mesh.vertex(corner);
+    }
+    mesh.end();
+}
+
+// reads one primitive after its keyword and adds its faces, false if the line doesn't fit the keyword
+static bool addPrimitive(const string& keyword, istringstream& in, const map<int, PaletteColor>& palette, MeshBuilder& mesh){
+    if (keyword == "box"){
+        cv::Point3f a, b;
+        int colors[6];
+        if (!readPoint(in, a) || !readPoint(in, b)){
+            return false;
+        }
+        for (int i = 0; i < 6; i++){
+            if (!readColor(in, palette, colors[i])){
+                return false;
+            }
+        }
+        // the faces at x0, x1, y0, y1, h0, h1
+        addFace(mesh, palette, colors[0], {{a.x, a.y, a.z}, {a.x, b.y, a.z}, {a.x, b.y, b.z}, {a.x, a.y, b.z}});
+        addFace(mesh, palette, colors[1], {{b.x, a.y, a.z}, {b.x, a.y, b.z}, {b.x, b.y, b.z}, {b.x, b.y, a.z}});
+        addFace(mesh, palette, colors[2], {{a.x, a.y, a.z}, {a.x, a.y, b.z}, {b.x, a.y, b.z}, {b.x, a.y, a.z}});
+        addFace(mesh, palette, colors[3], {{a.x, b.y, a.z}, {b.x, b.y, a.z}, {b.x, b.y, b.z}, {a.x, b.y, b.z}});
+        addFace(mesh, palette, colors[4], {{a.x, a.y, a.z}, {b.x, a.y, a.z}, {b.x, b.y, a.z}, {a.x, b.y, a.z}});
+        addFace(mesh, palette, colors[5], {{a.x, a.y, b.z}, {a.x, b.y, b.z}, {b.x, b.y, b.z}, {b.x, a.y, b.z}});
+    } else if (keyword == "cylinder"){
+        float x, y, h0, h1, radius;
+        int segments, bottom, top;
+        if (!(in >> x >> y >> h0 >> h1 >> radius >> segments) || segments < 3 || !readColor(in, palette, bottom) || !readColor(in, palette, top)){
+            return false;
+        }
+        // the side colors take up the rest of the line
+        vector<int> sides;
+        string token;
+        while (in >> token){
+            istringstream tokenIn(token);
+            int side;
+            if (!readColor(tokenIn, palette, side)){
+                return false;
+            }
+            sides.push_back(side);
+        }
+        if (sides.empty()){
+            return false;
+        }
+
+        // the rim starts on the y0 side of the center and runs towards x1
+        vector<cv::Point3f> lower(segments);
+        vector<cv::Point3f> upper(segments);
+        for (int i = 0; i < segments; i++){
+            double angle = 2 * CV_PI * i / segments;
+            lower[i] = cv::Point3f(x + radius * sin(angle), y - radius * cos(angle), -h0);
+            upper[i] = cv::Point3f(lower[i].x, lower[i].y, -h1);
+        }
+        addFace(mesh, palette, bottom, lower);
+        addFace(mesh, palette, top, upper);
+        for (int i = 0; i < segments; i++){
+            int j = (i + 1) % segments;
+            addFace(mesh, palette, sides[i % sides.size()], {lower[i], upper[i], upper[j], lower[j]});
+        }
+    } else if (keyword == "quad" || keyword == "triangle"){
+        vector<cv::Point3f> corners(keyword == "quad" ? 4 : 3);
+        int color;
+        for (cv::Point3f& corner : corners){
+            if (!readPoint(in, corner)){
+                return false;
+            }
+        }
+        if (!readColor(in, palette, color)){
+            return false;
+        }
+        addFace(mesh, palette, color, corners);
+    } else {
+        return false;
+    }
+    string rest;
+    return !(in >> rest);
+}
+
+/* ======================================== FURNITUREMODELS ======================================== */
+
+bool FurnitureModels::compile(const string& sourcePath, vector<MeshVertex>& vertices, vector<FurnitureModel>& models){
+    ifstream source(sourcePath);
+    if (!source){
+        cout << "[prog] could not read furniture models from " << sourcePath << endl;
+        return false;
+    }
+
+    map<int, PaletteColor> palette;
+    MeshBuilder mesh;
+    models.clear();
+    bool inModel = false;
+    string line;
+    for (int lineNumber = 1; getline(source, line); lineNumber++){
+        line = line.substr(0, line.find('#'));
+        istringstream in(line);
+        string keyword;
+        if (!(in >> keyword)){
+            continue;
+        }
+
+        string error;
+        if (keyword == "color"){
+            int index;
+            PaletteColor rgb;
+            string rest;
+            if (!(in >> index >> rgb[0] >> rgb[1] >> rgb[2]) || (in >> rest)){
+                error = "expected color <index> <r> <g> <b>";
+            } else {
+                palette[index] = rgb;
+            }
+        } else if (keyword == "model"){
+            FurnitureModel model;
+            if (inModel){
+                error = "model " + models.back().name + " has no end";
+            } else if (!(in >> model.name) || model.name.size() >= NAME_SIZE){
+                error = "expected model <name> shorter than " + to_string(NAME_SIZE) + " characters";
+            } else {
+                model.first = mesh.vertices.size();
+                models.push_back(model);
+                inModel = true;
+            }
+        } else if (keyword == "end"){
+            if (!inModel){
+                error = "end outside of a model";
+            } else {
+                models.back().count = mesh.vertices.size() - models.back().first;
+                inModel = false;
+            }
+        } else if (!inModel){
+            error = keyword + " outside of a model";
+        } else if (!addPrimitive(keyword, in, palette, mesh)){
+            error = "can't read " + keyword + ", see the format at the top of the file and check the palette indices";
+        }
+
+        if (!error.empty()){
+            cout << "[prog] " << sourcePath << ":" << lineNumber << ": " << error << endl;
+            return false;
+        }
+    }
+    if (inModel){
+        cout << "[prog] " << sourcePath << ": model " << models.back().name << " has no end" << endl;
+        return false;
+    }
+    vertices = std::move(mesh.vertices);
+    return true;
+}
+
+uint64_t FurnitureModels::hashSource(const string& sourcePath){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hashBytes(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    error_code error;
+    uintmax_t size = filesystem::file_size(sourcePath, error);
+    long long modified = filesystem::last_write_time(sourcePath, error).time_since_epoch().count();
+
+    string name = filesystem::path(sourcePath).filename().string();
+    hashBytes(hash, name.data(), name.size());
+    hashBytes(hash, &size, sizeof(size));
+    hashBytes(hash, &modified, sizeof(modified));
+    return hash;
+}
+
+bool FurnitureModels::load(const string& cachePath, uint64_t sourceHash, FurnitureMeshes& meshes){
+    unique_ptr<MappedFile> file = make_unique<MappedFile>(cachePath);
+    if (!file->data || file->size < sizeof(CacheHeader)){
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, file->data, sizeof(header));
+    if (memcmp(header.magic, "ARFM", 4) != 0 || header.version != CACHE_VERSION || header.sourceHash != sourceHash){
+        return false;
+    }
+    size_t modelsSize = header.modelCount * sizeof(CacheModel);
+    if (file->size != sizeof(header) + modelsSize + header.vertexCount * sizeof(MeshVertex)){
+        return false;
+    }
+
+    // only the model table is copied, the vertices stay in the mapping until they are uploaded
+    const CacheModel* cached = (const CacheModel*)(file->data + sizeof(header));
+    meshes.models.resize(header.modelCount);
+    for (uint32_t i = 0; i < header.modelCount; i++){
+        if (cached[i].name[NAME_SIZE - 1] != '\0' || cached[i].first + cached[i].count > header.vertexCount){
+            return false;
+        }
+        meshes.models[i].name = cached[i].name;
+        meshes.models[i].first = cached[i].first;
+        meshes.models[i].count = cached[i].count;
+    }
+    meshes.vertices = (const MeshVertex*)(file->data + sizeof(header) + modelsSize);
+    meshes.vertexCount = header.vertexCount;
+    meshes.mapping = std::move(file);
+    meshes.compiled.clear();
+    return true;
+}
+
+bool FurnitureModels::save(const string& cachePath, uint64_t sourceHash, const vector<MeshVertex>& vertices, const vector<FurnitureModel>& models){
+    CacheHeader header;
+    memcpy(header.magic, "ARFM", 4);
+    header.version = CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.modelCount = models.size();
+    header.vertexCount = vertices.size();
+
+    vector<CacheModel> cached(models.size());
+    for (int i = 0; i < (int)models.size(); i++){
+        memset(cached[i].name, 0, NAME_SIZE);
+        models[i].name.copy(cached[i].name, NAME_SIZE - 1);
+        cached[i].first = models[i].first;
+        cached[i].count = models[i].count;
+    }
+
+    // write next to the cache and swap it in, so a crash never leaves a half written cache behind
+    string tmpPath = cachePath + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)cached.data(), cached.size() * sizeof(CacheModel));
+        out.write((const char*)vertices.data(), vertices.size() * sizeof(MeshVertex));
+        if (!out){
+            return false;
+        }
+    }
+    error_code error;
+    filesystem::rename(tmpPath, cachePath, error);
+    return !error;
+}
+
+bool FurnitureModels::loadOrCompile(const string& sourcePath, const string& cachePath, FurnitureMeshes& meshes){
+    uint64_t sourceHash = hashSource(sourcePath);
+    if (load(cachePath, sourceHash, meshes)){
+        cout << "[prog] loaded furniture models from " << cachePath << endl;
+        return true;
+    }
+
+    cout << "[prog] compiling furniture models from " << sourcePath << endl;
+    if (!compile(sourcePath, meshes.compiled, meshes.models)){
+        return false;
+    }
+    meshes.vertices = meshes.compiled.data();
+    meshes.vertexCount = meshes.compiled.size();
+    meshes.mapping.reset();
+    if (save(cachePath, sourceHash, meshes.compiled, meshes.models)){
+        cout << "[prog] saved furniture models to " << cachePath << endl;
+    } else {
+        cout << "[prog] could not save furniture models to " << cachePath << endl;
+    }
+    return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <memory>
+#include "MeshBuilder.h"
+#include "MappedFile.h"
+
+using namespace std;
+
+/* A model of the furniture file, a run of vertices in FurnitureMeshes */
+struct FurnitureModel{
+    string name;
+    GLint first = 0;            // first vertex
+    GLsizei count = 0;          // vertex count, a multiple of 3
+};
+
+/* The triangles of every model one after the other, either mapped from the cache or just compiled */
+struct FurnitureMeshes{
+    vector<FurnitureModel> models;
+    const MeshVertex* vertices = nullptr;   // into mapping or into compiled
+    size_t vertexCount = 0;
+    unique_ptr<MappedFile> mapping;
+    vector<MeshVertex> compiled;
+};
+
+/**
+ * Furniture models written in a declarative text file (resources/furniture.txt) instead of C++
+ *
+ * Every model is a list of boxes, cylinders and single quads or triangles in marker space, colored by
+ * palette indices; the comment at the top of the file explains the format. The file is compiled into
+ * triangles once and cached in a binary file, which is memory-mapped on later launches so its vertices
+ * can go straight into the vertex buffer. The cache layout is
+ *
+ *      header      magic "ARFM", format version, source hash, number of models, number of vertices
+ *      models      32 byte name, first vertex and vertex count as uint32_t per model
+ *      vertices    MeshVertex per vertex
+ *
+ * Like the marker dictionary cache, the source hash covers the name, size and modification time of the
+ * text file, so editing a model only costs a recompile of that file on the next launch.
+*/
+class FurnitureModels{
+    public:
+        /**
+         * Compiles the text file into triangles
+         *
+         * @param sourcePath The path of the text file
+         * @param vertices Receives the triangles of all models
+         * @param models Receives the vertex range of each model
+         * @return false if the file can't be read or has an error, which is printed with its line
+        */
+        static bool compile(const string& sourcePath, vector<MeshVertex>& vertices, vector<FurnitureModel>& models);
+
+        /**
+         * Hashes the text file the models are compiled from
+         *
+         * @param sourcePath The path of the text file
+         * @return the hash stored in the cache file
+        */
+        static uint64_t hashSource(const string& sourcePath);
+
+        /**
+         * Maps the compiled models from the cache file
+         *
+         * @param cachePath The path of the cache file
+         * @param sourceHash The hash of the current text file
+         * @param meshes Receives the models, its vertices point into the mapping it holds
+         * @return false if there is no cache file or it is outdated or damaged
+        */
+        static bool load(const string& cachePath, uint64_t sourceHash, FurnitureMeshes& meshes);
+
+        /**
+         * Writes the compiled models to the cache file, replacing it atomically
+         *
+         * @param cachePath The path of the cache file
+         * @param sourceHash The hash of the text file the models were compiled from
+         * @param vertices The triangles of all models
+         * @param models The vertex range of each model
+         * @return false if the file could not be written
+        */
+        static bool save(const string& cachePath, uint64_t sourceHash, const vector<MeshVertex>& vertices, const vector<FurnitureModel>& models);
+
+        /**
+         * Loads the models from the cache file, and compiles and saves them first if the cache is missing or
+         * the text file changed
+         *
+         * @param sourcePath The path of the text file
+         * @param cachePath The path of the cache file
+         * @param meshes Receives the models
+         * @return false if the text file can't be compiled
+        */
+        static bool loadOrCompile(const string& sourcePath, const string& cachePath, FurnitureMeshes& meshes);
+};
@@ -0,0 +1,235 @@
+#include "ImageKernels.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define IMAGEKERNELS_X86
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define IMAGEKERNELS_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace std;
+
+// fixed point weights of cvtColor(BGR2GRAY): 0.114, 0.587, 0.299 scaled by 2^14
+static const int WEIGHT_B = 1868;
+static const int WEIGHT_G = 9617;
+static const int WEIGHT_R = 4899;
+static const int WEIGHT_SHIFT = 14;
+
+/* ======================================== SCALAR ======================================== */
+
+static void grayThresholdInvScalar(const uchar* bgr, uchar* grey, uchar* thresh, int count, uchar threshold){
+    for (int i = 0; i < count; i++){
+        int value = (bgr[3 * i] * WEIGHT_B + bgr[3 * i + 1] * WEIGHT_G + bgr[3 * i + 2] * WEIGHT_R + (1 << (WEIGHT_SHIFT - 1))) >> WEIGHT_SHIFT;
+        grey[i] = (uchar)value;
+        thresh[i] = value <= threshold ? 255 : 0;
+    }
+}
+
+#ifdef IMAGEKERNELS_X86
+/* ======================================== SSE4.1 ======================================== */
+
+// splits 16 interleaved BGR pixels (48 bytes) into one register per channel
+__attribute__((target("sse4.1")))
+static inline void deinterleaveBGR(const uchar* bgr, __m128i& b, __m128i& g, __m128i& r){
+    __m128i a0 = _mm_loadu_si128((const __m128i*)bgr);
+    __m128i a1 = _mm_loadu_si128((const __m128i*)(bgr + 16));
+    __m128i a2 = _mm_loadu_si128((const __m128i*)(bgr + 32));
+    b = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(a0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(a1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(a2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)));
+    g = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(a0, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(a1, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(a2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)));
+    r = _mm_or_si128(_mm_or_si128(
+        _mm_shuffle_epi8(a0, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(a1, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))),
+        _mm_shuffle_epi8(a2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)));
+}
+
+// grey value of 8 pixels given as 16 bit channels, (b, g) and (r, 1) pairs go through one madd each
+__attribute__((target("sse4.1")))
+static inline __m128i weightedSum8(__m128i b16, __m128i g16, __m128i r16){
+    const __m128i weightsBG = _mm_setr_epi16(WEIGHT_B, WEIGHT_G, WEIGHT_B, WEIGHT_G, WEIGHT_B, WEIGHT_G, WEIGHT_B, WEIGHT_G);
+    const __m128i weightsR = _mm_setr_epi16(WEIGHT_R, 1 << (WEIGHT_SHIFT - 1), WEIGHT_R, 1 << (WEIGHT_SHIFT - 1),
+                                            WEIGHT_R, 1 << (WEIGHT_SHIFT - 1), WEIGHT_R, 1 << (WEIGHT_SHIFT - 1));
+    const __m128i one = _mm_set1_epi16(1);
+    __m128i low = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b16, g16), weightsBG), _mm_madd_epi16(_mm_unpacklo_epi16(r16, one), weightsR));
+    __m128i high = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b16, g16), weightsBG), _mm_madd_epi16(_mm_unpackhi_epi16(r16, one), weightsR));
+    return _mm_packus_epi32(_mm_srli_epi32(low, WEIGHT_SHIFT), _mm_srli_epi32(high, WEIGHT_SHIFT));
+}
+
+__attribute__((target("sse4.1")))
+static void grayThresholdInvSSE41(const uchar* bgr, uchar* grey, uchar* thresh, int count, uchar threshold){
+    const __m128i limit = _mm_set1_epi8((char)threshold);
+    int i = 0;
+    for (; i + 16 <= count; i += 16){
+        __m128i b, g, r;
+        deinterleaveBGR(bgr + 3 * i, b, g, r);
+        __m128i low = weightedSum8(_mm_cvtepu8_epi16(b), _mm_cvtepu8_epi16(g), _mm_cvtepu8_epi16(r));
+        __m128i high = weightedSum8(_mm_cvtepu8_epi16(_mm_srli_si128(b, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(g, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(r, 8)));
+        __m128i value = _mm_packus_epi16(low, high);
+        _mm_storeu_si128((__m128i*)(grey + i), value);
+        // value <= threshold  <=>  min(value, threshold) == value
+        _mm_storeu_si128((__m128i*)(thresh + i), _mm_cmpeq_epi8(_mm_min_epu8(value, limit), value));
+    }
+    grayThresholdInvScalar(bgr + 3 * i, grey + i, thresh + i, count - i, threshold);
+}
+
+/* ======================================== AVX2 ======================================== */
+
+// grey value of 16 pixels given as 16 bit channels, the unpacks and packs stay within a lane so the order is kept
+__attribute__((target("avx2")))
+static inline __m256i weightedSum16(__m256i b16, __m256i g16, __m256i r16){
+    const __m256i weightsBG = _mm256_set1_epi32((WEIGHT_G << 16) | WEIGHT_B);
+    const __m256i weightsR = _mm256_set1_epi32(((1 << (WEIGHT_SHIFT - 1)) << 16) | WEIGHT_R);
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i low = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(b16, g16), weightsBG), _mm256_madd_epi16(_mm256_unpacklo_epi16(r16, one), weightsR));
+    __m256i high = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(b16, g16), weightsBG), _mm256_madd_epi16(_mm256_unpackhi_epi16(r16, one), weightsR));
+    return _mm256_packus_epi32(_mm256_srli_epi32(low, WEIGHT_SHIFT), _mm256_srli_epi32(high, WEIGHT_SHIFT));
+}
+
+__attribute__((target("avx2")))
+static void grayThresholdInvAVX2(const uchar* bgr, uchar* grey, uchar* thresh, int count, uchar threshold){
+    const __m256i limit = _mm256_set1_epi8((char)threshold);
+    int i = 0;
+    for (; i + 32 <= count; i += 32){
+        // there is no 256 bit byte shuffle across lanes, so split the channels 16 pixels at a time
+        __m128i b0, g0, r0, b1, g1, r1;
+        deinterleaveBGR(bgr + 3 * i, b0, g0, r0);
+        deinterleaveBGR(bgr + 3 * i + 48, b1, g1, r1);
+        __m256i first = weightedSum16(_mm256_cvtepu8_epi16(b0), _mm256_cvtepu8_epi16(g0), _mm256_cvtepu8_epi16(r0));
+        __m256i second = weightedSum16(_mm256_cvtepu8_epi16(b1), _mm256_cvtepu8_epi16(g1), _mm256_cvtepu8_epi16(r1));
+        // packus works per lane, put the four 8 pixel blocks back in order
+        __m256i value = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8);
+        _mm256_storeu_si256((__m256i*)(grey + i), value);
+        _mm256_storeu_si256((__m256i*)(thresh + i), _mm256_cmpeq_epi8(_mm256_min_epu8(value, limit), value));
+    }
+    grayThresholdInvSSE41(bgr + 3 * i, grey + i, thresh + i, count - i, threshold);
+}
+#endif
+
+#ifdef IMAGEKERNELS_NEON
+/* ======================================== NEON ======================================== */
+
+static inline uint16x8_t weightedSum8(uint8x8_t b, uint8x8_t g, uint8x8_t r){
+    uint16x8_t b16 = vmovl_u8(b), g16 = vmovl_u8(g), r16 = vmovl_u8(r);
+    uint32x4_t low = vmull_n_u16(vget_low_u16(b16), WEIGHT_B);
+    low = vmlal_n_u16(low, vget_low_u16(g16), WEIGHT_G);
+    low = vmlal_n_u16(low, vget_low_u16(r16), WEIGHT_R);
+    uint32x4_t high = vmull_n_u16(vget_high_u16(b16), WEIGHT_B);
+    high = vmlal_n_u16(high, vget_high_u16(g16), WEIGHT_G);
+    high = vmlal_n_u16(high, vget_high_u16(r16), WEIGHT_R);
+    // rounding shift, the same as adding 2^13 before shifting
+    return vcombine_u16(vrshrn_n_u32(low, WEIGHT_SHIFT), vrshrn_n_u32(high, WEIGHT_SHIFT));
+}
+
+static void grayThresholdInvNEON(const uchar* bgr, uchar* grey, uchar* thresh, int count, uchar threshold){
+    const uint8x16_t limit = vdupq_n_u8(threshold);
+    int i = 0;
+    for (; i + 16 <= count; i += 16){
+        uint8x16x3_t pixels = vld3q_u8(bgr + 3 * i);
+        uint16x8_t low = weightedSum8(vget_low_u8(pixels.val[0]), vget_low_u8(pixels.val[1]), vget_low_u8(pixels.val[2]));
+        uint16x8_t high = weightedSum8(vget_high_u8(pixels.val[0]), vget_high_u8(pixels.val[1]), vget_high_u8(pixels.val[2]));
+        uint8x16_t value = vcombine_u8(vqmovn_u16(low), vqmovn_u16(high));
+        vst1q_u8(grey + i, value);
+        vst1q_u8(thresh + i, vcleq_u8(value, limit));
+    }
+    grayThresholdInvScalar(bgr + 3 * i, grey + i, thresh + i, count - i, threshold);
+}
+#endif
+
+/* ======================================== DISPATCH ======================================== */
+
+typedef void (*GrayThresholdInvFunction)(const uchar*, uchar*, uchar*, int, uchar);
+
+struct GrayThresholdInv{
+    GrayThresholdInvFunction function;
+    const char* name;
+};
+
+// pick the implementation once, the first time it is needed
+static const GrayThresholdInv& grayThresholdInvKernel(){
+    static const GrayThresholdInv kernel = [](){
+#if defined(IMAGEKERNELS_X86)
+        if (__builtin_cpu_supports("avx2")){
+            return GrayThresholdInv{grayThresholdInvAVX2, "AVX2"};
+        }
+        if (__builtin_cpu_supports("sse4.1")){
+            return GrayThresholdInv{grayThresholdInvSSE41, "SSE4.1"};
+        }
+#elif defined(IMAGEKERNELS_NEON)
+        return GrayThresholdInv{grayThresholdInvNEON, "NEON"};
+#endif
+        return GrayThresholdInv{grayThresholdInvScalar, "scalar"};
+    }();
+    return kernel;
+}
+
+void ImageKernels::grayThresholdInv(const cv::Mat& frame, uchar threshold, cv::Mat& frame_grey, cv::Mat& frame_thresh){
+    CV_Assert(frame.type() == CV_8UC3);
+    frame_grey.create(frame.rows, frame.cols, CV_8UC1);
+    frame_thresh.create(frame.rows, frame.cols, CV_8UC1);
+
+    GrayThresholdInvFunction function = grayThresholdInvKernel().function;
+    if (frame.isContinuous() && frame_grey.isContinuous() && frame_thresh.isContinuous()){
+        function(frame.ptr<uchar>(0), frame_grey.ptr<uchar>(0), frame_thresh.ptr<uchar>(0), frame.rows * frame.cols, threshold);
+        return;
+    }
+    for (int y = 0; y < frame.rows; y++){
+        function(frame.ptr<uchar>(y), frame_grey.ptr<uchar>(y), frame_thresh.ptr<uchar>(y), frame.cols, threshold);
+    }
+}
+
+/* ======================================== ADAPTIVE THRESHOLD ======================================== */
+
+void ImageKernels::adaptiveThresholdInv(const cv::Mat& frame_grey, const cv::Mat& integral, int window, int offset, int threads, cv::Mat& frame_thresh){
+    CV_Assert(frame_grey.type() == CV_8UC1 && integral.type() == CV_32SC1);
+    CV_Assert(integral.rows == frame_grey.rows + 1 && integral.cols == frame_grey.cols + 1);
+    frame_thresh.create(frame_grey.rows, frame_grey.cols, CV_8UC1);
+
+    const int rows = frame_grey.rows;
+    const int cols = frame_grey.cols;
+    const int radius = window / 2;
+
+    cv::parallel_for_(cv::Range(0, rows), [&](const cv::Range& range){
+        for (int y = range.start; y < range.end; y++){
+            // the integral of a 4K frame can exceed INT_MAX, but the difference of two entries is exact modulo 2^32
+            const uint32_t* top = (const uint32_t*)integral.ptr<int>(max(y - radius, 0));
+            const uint32_t* bottom = (const uint32_t*)integral.ptr<int>(min(y + radius + 1, rows));
+            const uint32_t height = min(y + radius + 1, rows) - max(y - radius, 0);
+            const uchar* grey = frame_grey.ptr<uchar>(y);
+            uchar* thresh = frame_thresh.ptr<uchar>(y);
+
+            // dark if grey + offset <= sum / area, compared without dividing
+            auto binarize = [&](int x){
+                int x0 = max(x - radius, 0);
+                int x1 = min(x + radius + 1, cols);
+                uint32_t sum = bottom[x1] - bottom[x0] - top[x1] + top[x0];
+                thresh[x] = (grey[x] + offset) * height * (x1 - x0) <= sum ? 255 : 0;
+            };
+
+            int x = 0;
+            for (; x < min(radius, cols); x++){
+                binarize(x);
+            }
+            // away from the left and right border the window is always complete, this loop vectorizes
+            const uint32_t area = height * (2 * radius + 1);
+            for (; x + radius + 1 <= cols; x++){
+                uint32_t sum = bottom[x + radius + 1] - bottom[x - radius] - top[x + radius + 1] + top[x - radius];
+                thresh[x] = (grey[x] + offset) * area <= sum ? 255 : 0;
+            }
+            for (; x < cols; x++){
+                binarize(x);
+            }
+        }
+    }, threads > 0 ? threads : -1);
+}
+
+const char* ImageKernels::implementation(){
+    return grayThresholdInvKernel().name;
+}
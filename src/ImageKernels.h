@@ -0,0 +1,47 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+/**
+ * Per-pixel kernels of the detection
+ *
+ * grayThresholdInv has an SSE4.1, an AVX2 and a NEON implementation next to a scalar fallback. The x86
+ * implementation is picked once at runtime from what the CPU supports, NEON is always there on ARM64.
+*/
+class ImageKernels{
+    public:
+        /**
+         * Converts a BGR frame to greyscale and binarizes it in a single pass over the frame
+         *
+         * Does the work of cvtColor(BGR2GRAY), threshold(THRESH_BINARY) and bitwise_not at once: the grey
+         * value uses the same fixed point weights as cvtColor, the binary image is 255 where the grey value
+         * is at most the threshold (dark, potentially a marker border) and 0 elsewhere.
+         *
+         * @param frame The 8 bit BGR frame
+         * @param threshold The highest grey value that counts as dark
+         * @param frame_grey Receives the greyscale frame, reallocated only when the size changes
+         * @param frame_thresh Receives the inverted binary frame, reallocated only when the size changes
+        */
+        static void grayThresholdInv(const cv::Mat& frame, uchar threshold, cv::Mat& frame_grey, cv::Mat& frame_thresh);
+
+        /**
+         * Binarizes a greyscale frame against the mean of the square window around every pixel
+         *
+         * Same result as cv::adaptiveThreshold(ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY_INV): 255 where the pixel is
+         * at least offset darker than its window, 0 elsewhere. The window sums come from the integral image with
+         * 4 lookups each, so the cost doesn't depend on the window size. The rows are split into stripes that are
+         * binarized in parallel.
+         *
+         * @param frame_grey The greyscale frame
+         * @param integral The integral image of frame_grey (cv::integral with CV_32S)
+         * @param window The side length of the window in pixels, odd, cut off at the frame borders
+         * @param offset How much darker than the window mean a pixel has to be to count as dark
+         * @param threads The number of stripes processed in parallel (cv::parallel_for_), 0 or less lets OpenCV split the rows
+         * @param frame_thresh Receives the inverted binary frame, reallocated only when the size changes
+        */
+        static void adaptiveThresholdInv(const cv::Mat& frame_grey, const cv::Mat& integral, int window, int offset, int threads, cv::Mat& frame_thresh);
+
+        /* Name of the grayThresholdInv implementation picked for this CPU, for logging */
+        static const char* implementation();
+};
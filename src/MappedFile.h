@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+
+using namespace std;
+
+/* A whole file mapped read-only into memory, data stays nullptr if it can't be opened */
+struct MappedFile{
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+
+    explicit MappedFile(const string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+};
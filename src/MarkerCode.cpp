@@ -0,0 +1,218 @@
+#include "MarkerCode.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define MARKERCODE_AVX2
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define MARKERCODE_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace std;
+
+static inline int popcount64(uint64_t value){
+#if defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(value);
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(value);
+#else
+    // SWAR popcount
+    value = value - ((value >> 1) & 0x5555555555555555ULL);
+    value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+    value = (value + (value >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/* ======================================== BATCH SCORING ======================================== */
+
+static void hammingDistancesScalar(uint64_t code, const uint64_t* codes, size_t count, uint8_t* distances){
+    for (size_t i = 0; i < count; i++){
+        distances[i] = (uint8_t)popcount64(code ^ codes[i]);
+    }
+}
+
+#ifdef MARKERCODE_AVX2
+// AVX2 has no 64 bit popcount, so count the bits per nibble with a shuffle lookup and sum the bytes of each lane with SAD
+__attribute__((target("avx2")))
+static void hammingDistancesAVX2(uint64_t code, const uint64_t* codes, size_t count, uint8_t* distances){
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0F);
+    const __m256i query = _mm256_set1_epi64x((long long)code);
+    alignas(32) uint64_t sums[4];
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4){
+        __m256i diff = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(codes + i)), query);
+        __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(diff, lowNibble));
+        __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(diff, 4), lowNibble));
+        __m256i bytes = _mm256_add_epi8(low, high);
+        _mm256_store_si256((__m256i*)sums, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+        distances[i] = (uint8_t)sums[0];
+        distances[i + 1] = (uint8_t)sums[1];
+        distances[i + 2] = (uint8_t)sums[2];
+        distances[i + 3] = (uint8_t)sums[3];
+    }
+    hammingDistancesScalar(code, codes + i, count - i, distances + i);
+}
+#endif
+
+#ifdef MARKERCODE_NEON
+static void hammingDistancesNEON(uint64_t code, const uint64_t* codes, size_t count, uint8_t* distances){
+    const uint64x2_t query = vdupq_n_u64(code);
+
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2){
+        uint64x2_t diff = veorq_u64(vld1q_u64(codes + i), query);
+        // count the bits per byte, then widen and add the bytes of each lane
+        uint64x2_t sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(vcntq_u8(vreinterpretq_u8_u64(diff)))));
+        distances[i] = (uint8_t)vgetq_lane_u64(sums, 0);
+        distances[i + 1] = (uint8_t)vgetq_lane_u64(sums, 1);
+    }
+    hammingDistancesScalar(code, codes + i, count - i, distances + i);
+}
+#endif
+
+typedef void (*HammingBatchFunction)(uint64_t, const uint64_t*, size_t, uint8_t*);
+
+struct HammingBatch{
+    HammingBatchFunction function;
+    const char* name;
+};
+
+// pick the implementation once, the first time it is needed
+static const HammingBatch& hammingBatch(){
+    static const HammingBatch batch = [](){
+#if defined(MARKERCODE_AVX2)
+        if (__builtin_cpu_supports("avx2")){
+            return HammingBatch{hammingDistancesAVX2, "AVX2"};
+        }
+#elif defined(MARKERCODE_NEON)
+        return HammingBatch{hammingDistancesNEON, "NEON"};
+#endif
+        return HammingBatch{hammingDistancesScalar, "scalar"};
+    }();
+    return batch;
+}
+
+/* ======================================== MARKERCODE ======================================== */
+
+int MarkerCode::hammingDistance(uint64_t a, uint64_t b){
+    return popcount64(a ^ b);
+}
+
+void MarkerCode::hammingDistances(uint64_t code, const vector<uint64_t>& codes, vector<uint8_t>& distances){
+    distances.resize(codes.size());
+    hammingBatch().function(code, codes.data(), codes.size(), distances.data());
+}
+
+uint64_t MarkerCode::rotate(uint64_t code, int gridSize){
+    // rotating clockwise moves the cell (gridSize - 1 - column, row) to (row, column)
+    uint64_t rotated = 0;
+    for (int row = 0; row < gridSize; row++){
+        for (int column = 0; column < gridSize; column++){
+            int source = (gridSize - 1 - column) * gridSize + row;
+            if ((code >> source) & 1){
+                rotated |= 1ULL << (row * gridSize + column);
+            }
+        }
+    }
+    return rotated;
+}
+
+const char* MarkerCode::implementation(){
+    return hammingBatch().name;
+}
+
+/* ======================================== MARKERINDEX ======================================== */
+
+void MarkerIndex::build(const vector<uint64_t>& codes){
+    this->codes = codes;
+    exact.clear();
+    nodes.clear();
+
+    for (int i = 0; i < (int)codes.size(); i++){
+        // equal codes (e.g. the rotations of a symmetric marker) keep the first index
+        if (!exact.emplace(codes[i], i).second){
+            continue;
+        }
+
+        Node node;
+        node.code = codes[i];
+        node.index = i;
+        if (nodes.empty()){
+            node.edge = 0;
+            nodes.push_back(node);
+            continue;
+        }
+
+        // walk down the children with the same distance until there is a free spot
+        int parent = 0;
+        while (true){
+            node.edge = MarkerCode::hammingDistance(nodes[parent].code, node.code);
+            int child = nodes[parent].firstChild;
+            while (child != -1 && nodes[child].edge != node.edge){
+                child = nodes[child].nextSibling;
+            }
+            if (child == -1){
+                node.nextSibling = nodes[parent].firstChild;
+                nodes[parent].firstChild = nodes.size();
+                nodes.push_back(node);
+                break;
+            }
+            parent = child;
+        }
+    }
+}
+
+int MarkerIndex::find(uint64_t code, int maxDistance, vector<uint8_t>& distances, int& distance) const{
+    distance = 0;
+    unordered_map<uint64_t, int>::const_iterator it = exact.find(code);
+    if (it != exact.end()){
+        return it->second;
+    }
+    if (maxDistance <= 0 || nodes.empty()){
+        return -1;
+    }
+
+    int bestIndex = -1;
+    int bestDistance = maxDistance;
+    if (codes.size() <= linearScanLimit){
+        MarkerCode::hammingDistances(code, codes, distances);
+        for (int i = 0; i < (int)distances.size(); i++){
+            if (distances[i] < bestDistance || (distances[i] == bestDistance && bestIndex == -1)){
+                bestIndex = i;
+                bestDistance = distances[i];
+            }
+        }
+    } else {
+        search(0, code, bestIndex, bestDistance);
+    }
+
+    distance = bestDistance;
+    return bestIndex;
+}
+
+void MarkerIndex::search(int node, uint64_t code, int& bestIndex, int& bestDistance) const{
+    const Node& current = nodes[node];
+    int d = MarkerCode::hammingDistance(current.code, code);
+    if (d < bestDistance || (d == bestDistance && (bestIndex == -1 || current.index < bestIndex))){
+        bestIndex = current.index;
+        bestDistance = d;
+    }
+
+    // only subtrees at an edge within bestDistance of d can hold a code that is at least as close
+    for (int child = current.firstChild; child != -1; child = nodes[child].nextSibling){
+        int edge = nodes[child].edge;
+        if (edge >= d - bestDistance && edge <= d + bestDistance){
+            search(child, code, bestIndex, bestDistance);
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * Bit-packed marker codes
+ *
+ * A marker code holds the cells of a marker grid (black -> 0, white -> 1) in row-major order, cell
+ * (row, column) at bit row * gridSize + column. Grids up to 8x8 fit into a single uint64_t, so two
+ * codes are compared with one XOR and a popcount instead of a loop over every cell.
+*/
+class MarkerCode{
+    public:
+        /**
+         * Number of differing cells between two codes
+         *
+         * @param a The first code
+         * @param b The second code
+         * @return the Hamming distance between the two codes
+        */
+        static int hammingDistance(uint64_t a, uint64_t b);
+
+        /**
+         * Scores one code against a whole dictionary at once
+         *
+         * Uses AVX2 or NEON when the CPU supports it (picked once at runtime) and a scalar popcount loop otherwise.
+         *
+         * @param code The code read from a candidate marker
+         * @param codes The dictionary codes
+         * @param distances Receives the Hamming distance to every dictionary code
+        */
+        static void hammingDistances(uint64_t code, const vector<uint64_t>& codes, vector<uint8_t>& distances);
+
+        /**
+         * Rotates a code by 90 degrees clockwise, the same as cv::rotate(..., cv::ROTATE_90_CLOCKWISE) on the marker image
+         *
+         * @param code The code to rotate
+         * @param gridSize The number of rows/columns of the marker grid
+         * @return the rotated code
+        */
+        static uint64_t rotate(uint64_t code, int gridSize);
+
+        /* Name of the batch scoring implementation picked for this CPU, for logging */
+        static const char* implementation();
+};
+
+
+/**
+ * Index over the codes of a marker dictionary that finds the single closest code of a candidate
+ *
+ * Exact matches are looked up in a hash map. Matches within a Hamming radius come from a BK-tree: every
+ * child hangs off its parent by their distance, so by the triangle inequality only the children whose
+ * edge lies within the radius of the query's distance to the parent have to be visited. Small dictionaries
+ * are scored linearly with MarkerCode::hammingDistances instead, which beats walking the tree there.
+ * Lookups don't modify the index, so the detection threads can share one.
+*/
+class MarkerIndex{
+    public:
+        /**
+         * Builds the index, replacing the previous one
+         *
+         * @param codes The dictionary codes, their position is the index returned by find()
+        */
+        void build(const vector<uint64_t>& codes);
+
+        /**
+         * Finds the dictionary code closest to a candidate code
+         *
+         * Ties are broken by the lower dictionary index.
+         *
+         * @param code The code read from a candidate marker
+         * @param maxDistance The maximum number of differing cells
+         * @param distances Scratch buffer for the linear scan of small dictionaries
+         * @param distance Receives the Hamming distance of the match
+         * @return the dictionary index of the match, -1 if no code is within maxDistance
+        */
+        int find(uint64_t code, int maxDistance, vector<uint8_t>& distances, int& distance) const;
+
+    private:
+        // a BK-tree node, the children of a node form a linked list
+        struct Node{
+            uint64_t code;
+            int index;
+            int edge;               // distance to the parent node
+            int firstChild = -1;
+            int nextSibling = -1;
+        };
+
+        void search(int node, uint64_t code, int& bestIndex, int& bestDistance) const;
+
+        // dictionaries up to this size are scored linearly
+        static const size_t linearScanLimit = 512;
+
+        vector<uint64_t> codes;
+        unordered_map<uint64_t, int> exact;     // code -> lowest dictionary index with that code
+        vector<Node> nodes;                     // nodes[0] is the root
+};
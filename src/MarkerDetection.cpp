@@ -1,32 +1,136 @@
 #include "MarkerDetection.h"
+#include "FrameStats.h"
+#include "ImageKernels.h"
+#include <filesystem>
 
 using namespace std;
-#define CAM_MTX = (cv::Mat_<float>(3, 3) << 1000, 0.0, 500, 0.0, 1000, 500, 0.0, 0.0, 1.0)
-#define CAM_DIST = (cv::Mat_<float>(1, 4) << 0, 0, 0, 0);
 
-vector<vector<cv::Point>> MarkerDetection::findContourAndSquare(cv::Mat frame, bool debug=false){
-    vector<vector<cv::Point>> candidates;
-    cv::Mat frame_copy = frame.clone();
+void MarkerDetection::toGray(const cv::Mat& frame, cv::Mat& frame_grey){
+    // greyscale is easier to analyze, the intensity matters rather than the color
+    if (frame.channels() == 1){
+        frame_grey = frame;
+    } else if (frame.channels() == 2){
+        // YUYV: the Y of every pixel is the first channel
+        cv::extractChannel(frame, frame_grey, 0);
+    } else if (frame.channels() == 4){
+        cv::cvtColor(frame, frame_grey, cv::COLOR_BGRA2GRAY);
+    } else {
+        cv::cvtColor(frame, frame_grey, cv::COLOR_BGR2GRAY);
+    }
+    if (frame.channels() != 1){
+        FrameStats::countCopy(frame_grey);
+    }
+}
 
-    /* RGB to Greyscale --> easier to analyze the intensity rather than the color */
-    cv::Mat frame_grey;
-    cv::cvtColor(frame_copy, frame_grey, cv::COLOR_BGR2GRAY);
+// grey values up to this are dark enough to be part of a marker border
+static const uchar BINARY_THRESHOLD = 95;
+// in adaptive mode, a pixel has to be this much darker than the mean of its window
+static const int ADAPTIVE_OFFSET = 7;
+// markers are searched on the smallest pyramid level where the smallest marker still has at least this side length
+static const int MIN_SEARCH_SIDE = 24;
+static const int MAX_SEARCH_LEVEL = 3;
+
+int MarkerDetection::searchLevel(int minMarkerSize){
+    int level = 0;
+    while (level < MAX_SEARCH_LEVEL && (minMarkerSize >> (level + 1)) >= MIN_SEARCH_SIDE){
+        level++;
+    }
+    return level;
+}
 
-    /* tresholding */
-    cv::Mat frame_thresh;
-    cv::threshold(frame_grey, frame_thresh, 95, 255, cv::THRESH_BINARY);
-    
+void MarkerDetection::preprocess(const cv::Mat& frame, bool adaptive, int level, int threads, cv::Mat& frame_grey, DetectionBuffers& buffers){
+    if (!adaptive && level == 0 && frame.type() == CV_8UC3){
+        // one pass over the BGR frame instead of cvtColor, threshold and bitwise_not
+        ImageKernels::grayThresholdInv(frame, BINARY_THRESHOLD, frame_grey, buffers.frame_thresh);
+        FrameStats::countCopy(frame_grey);
+        return;
+    }
+    toGray(frame, frame_grey);
+
+    // the contours are searched on the downscaled frame, the markers are still decoded at full resolution
+    const cv::Mat* search = &frame_grey;
+    if (level > 0){
+        int scale = 1 << level;
+        cv::resize(frame_grey, buffers.frame_small, cv::Size(frame_grey.cols / scale, frame_grey.rows / scale), 0, 0, cv::INTER_AREA);
+        search = &buffers.frame_small;
+    }
+
+    if (!adaptive){
+        cv::threshold(*search, buffers.frame_thresh, BINARY_THRESHOLD, 255, cv::THRESH_BINARY_INV);
+        return;
+    }
+    // the window has to be wider than the black border of a marker, or the inside of the border counts as bright
+    int window = max(15, min(search->cols, search->rows) / 24) | 1;
+    cv::integral(*search, buffers.integral, CV_32S);
+    ImageKernels::adaptiveThresholdInv(*search, buffers.integral, window, ADAPTIVE_OFFSET, threads, buffers.frame_thresh);
+}
+
+void MarkerDetection::preprocessRegions(const cv::Mat& frame, bool adaptive, int threads, const vector<cv::Rect>& regions, cv::Mat& frame_grey, DetectionBuffers& buffers){
+    // only the regions are written, the rest of both images is stale and never read
+    if (frame.channels() == 1){
+        frame_grey = frame;
+    } else {
+        frame_grey.create(frame.rows, frame.cols, CV_8UC1);
+    }
+    buffers.frame_thresh.create(frame.rows, frame.cols, CV_8UC1);
+    int window = max(15, min(frame.cols, frame.rows) / 24) | 1;
+
+    for (const cv::Rect& region : regions){
+        // headers into the full images, the conversions below write through them without reallocating
+        cv::Mat grey = frame_grey(region);
+        cv::Mat thresh = buffers.frame_thresh(region);
+        if (!adaptive && frame.type() == CV_8UC3){
+            ImageKernels::grayThresholdInv(frame(region), BINARY_THRESHOLD, grey, thresh);
+            FrameStats::countCopy(grey);
+            continue;
+        }
+        if (frame.channels() != 1){
+            toGray(frame(region), grey);
+        }
+        if (!adaptive){
+            cv::threshold(grey, thresh, BINARY_THRESHOLD, 255, cv::THRESH_BINARY_INV);
+        } else {
+            cv::integral(grey, buffers.integral, CV_32S);
+            ImageKernels::adaptiveThresholdInv(grey, buffers.integral, window, ADAPTIVE_OFFSET, threads, thresh);
+        }
+    }
+}
+
+void MarkerDetection::findContourAndSquareInRegions(const cv::Mat& frame_thresh, const vector<cv::Rect>& regions, DetectionBuffers& buffers){
+    vector<vector<cv::Point2f>>& found = buffers.region_candidates;
+    size_t numCandidates = 0;
+    for (const cv::Rect& region : regions){
+        // a square touching the edge of its region is cut off and dropped, the padding of the regions keeps that rare
+        findContourAndSquare(frame_thresh(region), buffers, false);
+        cv::Point2f offset(region.x, region.y);
+        for (const vector<cv::Point2f>& candidate : buffers.candidates){
+            if (numCandidates == found.size()){
+                found.emplace_back();
+            }
+            vector<cv::Point2f>& square = found[numCandidates++];
+            square = candidate;
+            for (cv::Point2f& corner : square){
+                corner += offset;
+            }
+        }
+    }
+    found.resize(numCandidates);
+    // swapping keeps the capacity of both lists for the next frame
+    swap(buffers.candidates, found);
+}
+
+void MarkerDetection::findContourAndSquare(const cv::Mat& frame_thresh, DetectionBuffers& buffers, bool debug=false){
+    vector<vector<cv::Point2f>>& candidates = buffers.candidates;
+    size_t numCandidates = 0;
 
     /* find contours */
-    // invert image because findContours() finds white objects on black background
-    frame_thresh = ~frame_thresh;
-    vector<vector<cv::Point>> contours;
+    // the binary frame is inverted because findContours() finds white objects on black background
+    vector<vector<cv::Point>>& contours = buffers.contours;
     // use external contour to remove inner contours inside the marker
     cv::findContours(frame_thresh, contours, cv::RETR_EXTERNAL , cv::CHAIN_APPROX_SIMPLE);
-    cv::cvtColor(frame_thresh, frame_thresh, cv::COLOR_GRAY2BGR);
 
     /* find squares --> any 4 corner contour*/
-    vector<cv::Point> contour_poly_approx;
+    vector<cv::Point>& contour_poly_approx = buffers.contour_poly_approx;
     for (int i = 0; i < contours.size(); i++){
         // approximate contour to a polygon
         double epsilon = 0.02 * cv::arcLength(contours[i], true);
@@ -36,7 +140,7 @@ vector<vector<cv::Point>> MarkerDetection::findContourAndSquare(cv::Mat frame, b
         // if contour is not a square, continue
         if (contour_poly_approx.size() != 4 || !cv::isContourConvex(contour_poly_approx) || cv::contourArea(contour_poly_approx) < 100
         /* don't include contour if it touches the border of the image */
-        || r.x <= 0 || r.y <= 0 || r.x + r.width >= frame_copy.cols || r.y + r.height >= frame_copy.rows){
+        || r.x <= 0 || r.y <= 0 || r.x + r.width >= frame_thresh.cols || r.y + r.height >= frame_thresh.rows){
             continue;
         }
 
@@ -51,62 +155,59 @@ vector<vector<cv::Point>> MarkerDetection::findContourAndSquare(cv::Mat frame, b
             cv::swap(contour_poly_approx[0], contour_poly_approx[1]);
             cv::swap(contour_poly_approx[2], contour_poly_approx[3]);  
         }
-        candidates.push_back(contour_poly_approx);
+        // reuse the candidate vectors of the previous frame
+        if (numCandidates == candidates.size()){
+            candidates.emplace_back();
+        }
+        candidates[numCandidates++].assign(contour_poly_approx.begin(), contour_poly_approx.end());
     }
+    candidates.resize(numCandidates);
 
     // for debugging purposes
     if (debug){
+        cv::Mat frame_debug;
+        cv::cvtColor(frame_thresh, frame_debug, cv::COLOR_GRAY2BGR);
         for (int i = 0; i < candidates.size(); i++){
-            vector <cv::Point> candidate = candidates[i];
             // cout << "Candidate " << i << ": " << candidate << endl;
             cv::Scalar colour = cv::Scalar(255, 0, 255);
-            cv::Rect r = cv::boundingRect(candidates[i]);
-            cv::polylines(frame_thresh, candidates[i], true, colour, 2);
-            cv::circle(frame_thresh, candidates[i][0], 3, cv::Scalar(0, 0, 255), 2);      // red
-            cv::circle(frame_thresh, candidates[i][1], 3, cv::Scalar(0, 255, 0), 2);      // green
-            cv::circle(frame_thresh, candidates[i][2], 3, cv::Scalar(255, 0, 0), 2);      // blue
-            cv::circle(frame_thresh, candidates[i][3], 3, cv::Scalar(0, 255, 255), 2);    // yellow
+            vector<cv::Point> polygon(candidates[i].begin(), candidates[i].end());
+            cv::polylines(frame_debug, polygon, true, colour, 2);
+            cv::circle(frame_debug, candidates[i][0], 3, cv::Scalar(0, 0, 255), 2);      // red
+            cv::circle(frame_debug, candidates[i][1], 3, cv::Scalar(0, 255, 0), 2);      // green
+            cv::circle(frame_debug, candidates[i][2], 3, cv::Scalar(255, 0, 0), 2);      // blue
+            cv::circle(frame_debug, candidates[i][3], 3, cv::Scalar(0, 255, 255), 2);    // yellow
         }
         // end of debugging purposes
-        cv::imshow("Contoured and Squared", frame_thresh);
+        cv::imshow("Contoured and Squared", frame_debug);
     }
-
-    return candidates;
 }
 
-vector<int> MarkerDetection::getIds(cv::Mat frame, vector<cv::Point> square_contour, int bits, bool debug=false){
+void MarkerDetection::getIds(const cv::Mat& frame_grey, const vector<cv::Point2f>& square_contour, int bits, DecodeBuffers& buffers, uint64_t& code, bool debug=false){
     int numPixels = sqrt(bits);
     float bits_f = static_cast<float>(bits);
 
     /* get transformation matrix to warp the image into the defined corners */
     // clockwise order from top left corner of the square 
-    vector<cv::Point2f> corners{cv::Point2f{0, 0}, cv::Point2f{bits_f, 0}, cv::Point2f{bits_f, bits_f}, cv::Point2f{0, bits_f}};
-
-    // convert square contour to float
-    vector<cv::Point2f> square_contour_float;
-    for (int i = 0; i < square_contour.size(); i++){
-        square_contour_float.push_back(cv::Point2f(square_contour[i].x, square_contour[i].y));
-    }
-    cv::Mat transformationM = cv::getPerspectiveTransform(square_contour_float, corners);
+    cv::Point2f corners[4] = {cv::Point2f{0, 0}, cv::Point2f{bits_f, 0}, cv::Point2f{bits_f, bits_f}, cv::Point2f{0, bits_f}};
+    cv::Mat transformationM = cv::getPerspectiveTransform(square_contour.data(), corners);
     
     /* warp image into a straightened square with the size bits * bits */ 
-    cv::Mat warped;
-    cv::warpPerspective(frame, warped, transformationM, cv::Size(bits, bits));
+    cv::Mat& warped = buffers.warped;
+    cv::warpPerspective(frame_grey, warped, transformationM, cv::Size(bits, bits));
 
     /* noise reduction of the warped marker */
     // thresholding
-    cv::Mat warped_thresh;
-    cv::cvtColor(warped, warped, cv::COLOR_BGR2GRAY);
+    cv::Mat& warped_thresh = buffers.warped_thresh;
     cv::threshold(warped, warped_thresh, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU); // thresh_otsu scans the image to find the best threshold value
 
     // erosion
-    cv::Mat eroded = warped_thresh.clone();
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ERODE , cv::Size(3, 3));
-    cv::erode(eroded, eroded, kernel);
+    cv::Mat& eroded = buffers.eroded;
+    static const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ERODE , cv::Size(3, 3));
+    cv::erode(warped_thresh, eroded, kernel);
     
 
     /* read the bits from the warped marker per cell (center point of each cell), each cell is numPixel * numPixel in size */
-    vector<int> ids;
+    code = 0;
     for (int row = 0; row < numPixels; row++){
         for (int column = 0; column < numPixels; column++){
             // get center of cell
@@ -118,16 +219,14 @@ vector<int> MarkerDetection::getIds(cv::Mat frame, vector<cv::Point> square_cont
             }
 
             if  (eroded.at<uchar>(y, x) >= 128){
-                ids.push_back(1);
-            } else {
-                ids.push_back(0);
+                code |= 1ULL << (row * numPixels + column);
             }
         }
     }
-    
-    cv::cvtColor(eroded, eroded, cv::COLOR_GRAY2BGR);
 
     if (debug){
+        cv::cvtColor(eroded, eroded, cv::COLOR_GRAY2BGR);
+
         // draw grid lines for analysis
         for (int i = 0; i < numPixels; i++){
             cv::line(eroded, cv::Point2f(0, i * (bits / numPixels)), cv::Point2f(bits, i * (bits / numPixels)), cv::Scalar(255, 128, 64), 1);
@@ -141,89 +240,357 @@ vector<int> MarkerDetection::getIds(cv::Mat frame, vector<cv::Point> square_cont
         cv::namedWindow("eroded", cv::WINDOW_NORMAL);
         cv::imshow("eroded", eroded);
     }
-    return ids;
 }
 
-MarkerDict MarkerDetection::constructMarkerDictionary(vector<string> markerPaths){
+// bilinear interpolation of the greyscale image at a sub-pixel position, clamped to the image
+static inline float sampleBilinear(const cv::Mat& frame_grey, float x, float y){
+    x = min(max(x, 0.0f), (float)(frame_grey.cols - 1));
+    y = min(max(y, 0.0f), (float)(frame_grey.rows - 1));
+    int x0 = (int)x;
+    int y0 = (int)y;
+    int x1 = min(x0 + 1, frame_grey.cols - 1);
+    int y1 = min(y0 + 1, frame_grey.rows - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+    const uchar* row0 = frame_grey.ptr<uchar>(y0);
+    const uchar* row1 = frame_grey.ptr<uchar>(y1);
+    float top = row0[x0] + (row0[x1] - row0[x0]) * fx;
+    float bottom = row1[x0] + (row1[x1] - row1[x0]) * fx;
+    return top + (bottom - top) * fy;
+}
+
+void MarkerDetection::sampleIds(const cv::Mat& frame_grey, const vector<cv::Point2f>& square_contour, int bits, uint64_t& code){
+    int numPixels = sqrt(bits);
+
+    /* homography from the unit square onto the clockwise corners, closed form (Heckbert) instead of solving a system */
+    double x0 = square_contour[0].x, y0 = square_contour[0].y;
+    double x1 = square_contour[1].x, y1 = square_contour[1].y;
+    double x2 = square_contour[2].x, y2 = square_contour[2].y;
+    double x3 = square_contour[3].x, y3 = square_contour[3].y;
+    double sx = x0 - x1 + x2 - x3;
+    double sy = y0 - y1 + y2 - y3;
+    double det = (x1 - x2) * (y3 - y2) - (x3 - x2) * (y1 - y2);
+    double g = det == 0 ? 0 : (sx * (y3 - y2) - (x3 - x2) * sy) / det;
+    double h = det == 0 ? 0 : ((x1 - x2) * sy - sx * (y1 - y2)) / det;
+    double a = x1 - x0 + g * x1, b = x3 - x0 + h * x3, c = x0;
+    double d = y1 - y0 + g * y1, e = y3 - y0 + h * y3, f = y0;
+
+    /* sample every cell around its center, 2x2 points at a quarter cell from the center */
+    static const float offsets[2] = {-0.25f, 0.25f};
+    float cells[64];
+    for (int row = 0; row < numPixels; row++){
+        for (int column = 0; column < numPixels; column++){
+            float sum = 0;
+            for (float dv : offsets){
+                for (float du : offsets){
+                    double u = (column + 0.5 + du) / numPixels;
+                    double v = (row + 0.5 + dv) / numPixels;
+                    double w = g * u + h * v + 1;
+                    sum += sampleBilinear(frame_grey, (a * u + b * v + c) / w, (d * u + e * v + f) / w);
+                }
+            }
+            cells[row * numPixels + column] = sum / 4;
+        }
+    }
+
+    /* threshold locally: the border cells are black, the brightest inner cell is white */
+    float black = 0;
+    int borderCells = 0;
+    float white = 0;
+    for (int row = 0; row < numPixels; row++){
+        for (int column = 0; column < numPixels; column++){
+            float value = cells[row * numPixels + column];
+            if (row == 0 || column == 0 || row == numPixels - 1 || column == numPixels - 1){
+                black += value;
+                borderCells++;
+            } else {
+                white = max(white, value);
+            }
+        }
+    }
+    black /= borderCells;
+    // without enough contrast there is no white cell, keep the threshold above the noise of the black ones
+    float threshold = max((black + white) / 2, black + 20);
+
+    code = 0;
+    for (int i = 0; i < numPixels * numPixels; i++){
+        if (cells[i] >= threshold){
+            code |= 1ULL << i;
+        }
+    }
+}
+
+vector<string> MarkerDetection::listMarkerPaths(const string& directory){
+    // read the files in a directory
+    vector<string> markerPaths;
+    for (const auto & entry : filesystem::directory_iterator(directory)){
+        markerPaths.push_back(entry.path());
+    }
+    // sort the files in ascending order (marker0, marker1, marker2, ...)
+    std::sort(markerPaths.begin(), markerPaths.end());
+    return markerPaths;
+}
+
+// the objects of the printed marker images, the walls are in the order topLeft, topRight, bottomRight, bottomLeft
+// and the furniture in the order of the models in ObjectRender.cpp
+static const pair<const char*, MarkerObject> MARKER_OBJECTS[16] = {
+    {"marker1", {MARKER_WALL, 0}}, {"marker10", {MARKER_WALL, 1}}, {"marker11", {MARKER_WALL, 2}}, {"marker12", {MARKER_WALL, 3}},
+    {"marker2", {MARKER_FURNITURE, 0}}, {"marker3", {MARKER_FURNITURE, 1}}, {"marker4", {MARKER_FURNITURE, 2}}, {"marker5", {MARKER_FURNITURE, 3}},
+    {"marker6", {MARKER_FURNITURE, 4}}, {"marker7", {MARKER_FURNITURE, 5}}, {"marker8", {MARKER_FURNITURE, 6}}, {"marker9", {MARKER_FURNITURE, 7}},
+    {"marker91", {MARKER_FURNITURE, 8}}, {"marker92", {MARKER_FURNITURE, 9}}, {"marker93", {MARKER_FURNITURE, 10}}, {"marker94", {MARKER_FURNITURE, 11}}};
+
+MarkerObject MarkerDetection::markerObject(const string& markerPath){
+    string name = filesystem::path(markerPath).stem().string();
+    for (const pair<const char*, MarkerObject>& entry : MARKER_OBJECTS){
+        if (name == entry.first){
+            return entry.second;
+        }
+    }
+    return MarkerObject();
+}
+
+MarkerDict MarkerDetection::constructMarkerDictionary(const vector<string>& markerPaths){
     MarkerDict dict;
-    for (string path : markerPaths){
+    DecodeBuffers buffers;
+    uint64_t code;
+    for (const string& path : markerPaths){
         cout << "\t" << path << endl;
-        cv::Mat marker = cv::imread(path);
+        cv::Mat marker = cv::imread(path, cv::IMREAD_GRAYSCALE);
 
         int cols = marker.cols;
         int rows = marker.rows;
 
-        vector<cv::Point> dummy_contour{cv::Point{0, 0}, cv::Point{cols, 0}, cv::Point{cols, rows}, cv::Point{0, rows}};
+        vector<cv::Point2f> dummy_contour{cv::Point2f(0, 0), cv::Point2f(cols, 0), cv::Point2f(cols, rows), cv::Point2f(0, rows)};
         vector<cv::Point3f> dummy_orientation{cv::Point3f{0, 0, 0}, cv::Point3f{1, 0, 0}, cv::Point3f{1, 1, 0}, cv::Point3f{0, 1, 0}};
 
+        getIds(marker, dummy_contour, 36, buffers, code);
+        MarkerObject object = markerObject(path);
         for (int i = 0; i < 4; i++){
-            vector<int> ids = getIds(marker, dummy_contour, 36);
-
-            dict.ids.push_back(ids);
+            dict.codes.push_back(code);
             dict.orientations.push_back(dummy_orientation);
+            dict.objects.push_back(object);
 
-            // rotate marker 90 degrees
-            cv::rotate(marker, marker, cv::ROTATE_90_CLOCKWISE);
+            // rotate marker 90 degrees, on the packed code instead of warping the rotated image again
+            code = MarkerCode::rotate(code, 6);
 
             dummy_orientation.insert(dummy_orientation.begin(), dummy_orientation.back());
             dummy_orientation.pop_back();
         }
     }
+    dict.index.build(dict.codes);
     return dict;
 }
 
-vector<MarkerResult> MarkerDetection::detectMarker(cv::Mat frame, MarkerDict dict, int error_threshold=0, bool debug=false){
-    cv::Mat frame_clone = frame.clone();
-    vector<MarkerResult> results;
+void MarkerDetection::refineCorners(const cv::Mat& frame_grey, int level, DetectionBuffers& buffers){
+    vector<vector<cv::Point2f>>& candidates = buffers.candidates;
+    vector<cv::Point2f>& refined = buffers.refined_corners;
+    if (candidates.empty()){
+        return;
+    }
+
+    // the center of a pixel of the pyramid level lies in the middle of the scale * scale pixels it covers
+    int scale = 1 << level;
+    refined.resize(candidates.size() * 4);
+    for (int i = 0; i < candidates.size(); i++){
+        for (int j = 0; j < 4; j++){
+            refined[i * 4 + j] = cv::Point2f((candidates[i][j].x + 0.5f) * scale - 0.5f, (candidates[i][j].y + 0.5f) * scale - 0.5f);
+        }
+    }
+
+    // all corners at once, the search window covers the error of one pixel on the pyramid level
+    static const cv::TermCriteria criteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 12, 0.05);
+    int radius = scale + 2;
+    cv::cornerSubPix(frame_grey, refined, cv::Size(radius, radius), cv::Size(-1, -1), criteria);
 
+    for (int i = 0; i < candidates.size(); i++){
+        copy(refined.begin() + i * 4, refined.begin() + i * 4 + 4, candidates[i].begin());
+    }
+}
+
+void MarkerDetection::detectMarker(const cv::Mat& frame_grey, const cv::Mat& frame_thresh, int level, const MarkerDict& dict, int error_threshold, int decodeThreads, DetectionBuffers& buffers, vector<MarkerResult>& results, bool debug=false){
     // 1. find contours --> find white blobs over black background
     // 2. find squares --> find 4 corners of the marker
-    vector<vector<cv::Point>> candidates = findContourAndSquare(frame_clone, debug);
+    findContourAndSquare(frame_thresh, buffers, debug);
 
-    // 3. find marker
-    for (int i = 0; i < candidates.size(); i++){
-        vector<cv::Point> square = candidates[i];
-        vector<int> ids = getIds(frame_clone, square, 36, debug);
-
-        // check if ids match with dictionary, allow for some error
-        for (int j = 0; j < dict.ids.size(); j++){
-            int error = 0;
-            for (int k = 0; k < ids.size(); k++){
-                if (ids[k] != dict.ids[j][k]){
-                    error++;
+    // the squares were found on a pyramid level, move their corners back onto the full resolution frame
+    if (level > 0){
+        refineCorners(frame_grey, level, buffers);
+    }
+
+    decodeCandidates(frame_grey, dict, error_threshold, decodeThreads, buffers, results, debug);
+}
+
+void MarkerDetection::decodeCandidates(const cv::Mat& frame_grey, const MarkerDict& dict, int error_threshold, int decodeThreads, DetectionBuffers& buffers, vector<MarkerResult>& results, bool debug=false){
+    size_t numResults = 0;
+    const vector<vector<cv::Point2f>>& candidates = buffers.candidates;
+
+    // 3. decode the candidates, split into one contiguous block per thread
+    // the debug windows can only be shown from this thread
+    int stripes = debug ? 1 : max(1, min(decodeThreads, (int)candidates.size()));
+    if (buffers.decode.size() < stripes){
+        buffers.decode.resize(stripes);
+    }
+    buffers.codes.resize(candidates.size());
+    auto decodeStripes = [&](const cv::Range& range){
+        for (int stripe = range.start; stripe < range.end; stripe++){
+            // every stripe writes only to its own scratch buffers and its own slice of codes
+            DecodeBuffers& decodeBuffers = buffers.decode[stripe];
+            int first = candidates.size() * stripe / stripes;
+            int last = candidates.size() * (stripe + 1) / stripes;
+            for (int i = first; i < last; i++){
+                // the warped markers are only needed to show them in the debug windows
+                if (debug){
+                    getIds(frame_grey, candidates[i], 36, decodeBuffers, buffers.codes[i], debug);
+                } else {
+                    sampleIds(frame_grey, candidates[i], 36, buffers.codes[i]);
                 }
             }
+        }
+    };
+    if (stripes == 1){
+        decodeStripes(cv::Range(0, 1));
+    } else {
+        cv::parallel_for_(cv::Range(0, stripes), decodeStripes, stripes);
+    }
 
-            if (error <= error_threshold){
-                MarkerResult res;
-                res.index = j;
-                res.corners = square;
-                results.push_back(res);
+    // 4. find marker, in candidate order so the results don't depend on the number of threads
+    vector<uint8_t>& distances = buffers.distances;
+    for (int i = 0; i < candidates.size(); i++){
+        const vector<cv::Point2f>& square = candidates[i];
+
+        // look up the closest dictionary entry, allow for some error
+        int distance;
+        int index = dict.index.find(buffers.codes[i], error_threshold, distances, distance);
+        if (index != -1){
+            // reuse the result entries of the previous frame
+            if (numResults == results.size()){
+                results.emplace_back();
             }
+            MarkerResult& res = results[numResults++];
+            res.index = index;
+            res.corners = square;
         }
     }
+    results.resize(numResults);
+}
 
-    return results; 
+void MarkerDetection::undistortCorners(const vector<MarkerResult>& markers, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, vector<MarkerResult>& undistorted){
+    vector<cv::Point2f>& points = buffers.corner_points[0];
+    vector<cv::Point2f>& result = buffers.corner_points[1];
+    points.resize(markers.size() * 4);
+    for (int i = 0; i < markers.size(); i++){
+        for (int c = 0; c < 4; c++){
+            points[i * 4 + c] = markers[i].corners[c];
+        }
+    }
+    // projecting back with the camera matrix keeps the corners in pixels
+    if (!points.empty()){
+        cv::undistortPoints(points, result, cameraMatrix, distCoeffs, cv::noArray(), cameraMatrix);
+    }
+
+    undistorted.resize(markers.size());
+    for (int i = 0; i < markers.size(); i++){
+        undistorted[i].index = markers[i].index;
+        undistorted[i].corners.assign(result.begin() + i * 4, result.begin() + i * 4 + 4);
+    }
 }
 
-vector<cv::Point2f> MarkerDetection::poseEstimation(vector<cv::Point3f> orientations, vector<cv::Point> corners, cv::Mat cameraMatrix, cv::Mat distCoeffs){
-    // object points, which are the 3d points of the marker
-    vector<cv::Point3f> axis {cv::Point3f{0, 0, 0}, cv::Point3f{1, 0, 0}, cv::Point3f{0, 1, 0}, cv::Point3f{0, 0, -1},
-        cv::Point3f{1, 1, 0}, cv::Point3f{1, 1, -1}, cv::Point3f{1, 0, -1}, cv::Point3f{0, 1, -1}};
-    vector<cv::Point2f> projectedPoints;
+// a pose of a recent frame is refined instead of solved again, if it is at most this many frames old
+static const int MAX_GUESS_AGE = 8;
+// a refined pose further off the corners than this (in pixels) probably fell into the other planar solution
+static const double MAX_GUESS_ERROR = 2.0;
+
+void MarkerDetection::solvePose(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Vec3d& rvec, cv::Vec3d& tvec){
+    // IPPE_SQUARE wants the corners of a square of side 1 centered on the origin, in this order
+    static const vector<cv::Point3f> square {cv::Point3f{-0.5f, 0.5f, 0}, cv::Point3f{0.5f, 0.5f, 0}, cv::Point3f{0.5f, -0.5f, 0}, cv::Point3f{-0.5f, -0.5f, 0}};
+
+    // the orientation of the marker tells which image corner lies on which corner of the unit square
+    cv::Point2f corners2f[4];
+    for (int i = 0; i < 4; i++){
+        const cv::Point3f& o = orientations[i];
+        int j = o.y < 0.5f ? (o.x < 0.5f ? 0 : 1) : (o.x < 0.5f ? 3 : 2);
+        corners2f[j] = corners[i];
+    }
+    cv::Vec3d squareRvec, squareTvec;
+    cv::solvePnP(square, cv::Mat(4, 1, CV_32FC2, corners2f), cameraMatrix, distCoeffs, squareRvec, squareTvec, false, cv::SOLVEPNP_IPPE_SQUARE);
+
+    // the square frame is the marker frame turned upside down around x and shifted to the center:
+    // (x, y, 0) of the marker is (x - 0.5, 0.5 - y, 0) of the square
+    cv::Matx33d R;
+    cv::Rodrigues(squareRvec, R);
+    for (int i = 0; i < 3; i++){
+        tvec[i] = squareTvec[i] - 0.5 * R(i, 0) + 0.5 * R(i, 1);
+        R(i, 1) = -R(i, 1);
+        R(i, 2) = -R(i, 2);
+    }
+    cv::Rodrigues(R, rvec);
+}
 
-    cv::Mat rvec; // rotation vector of the marker
-    cv::Mat tvec; // translation vector of the marker
+double MarkerDetection::refinePose(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Vec3d& rvec, cv::Vec3d& tvec){
+    // Levenberg-Marquardt from the given pose, usually a few steps as the marker barely moved
+    cv::solvePnP(orientations, corners, cameraMatrix, distCoeffs, rvec, tvec, true, cv::SOLVEPNP_ITERATIVE);
+    return reprojectionError(orientations, corners, cameraMatrix, distCoeffs, rvec, tvec);
+}
 
-    vector<cv::Point2f> corners2f;
-    for (cv::Point& p : corners) {
-        corners2f.push_back(cv::Point2f(p.x, p.y));
+void MarkerDetection::trackPose(int index, long long sequence, const MarkerDict& dict, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, cv::Vec3d& rvec, cv::Vec3d& tvec){
+    // every rotation of a marker image describes the same physical square, so they share the pose
+    buffers.poses.resize(dict.codes.size() / 4);
+    PoseGuess& guess = buffers.poses[index / 4];
+    const vector<cv::Point3f>& orientations = dict.orientations[index];
+
+    bool refined = false;
+    if (guess.sequence >= 0 && sequence > guess.sequence && sequence - guess.sequence <= MAX_GUESS_AGE){
+        rvec = guess.rvec;
+        tvec = guess.tvec;
+        refined = refinePose(orientations, corners, cameraMatrix, distCoeffs, rvec, tvec) <= MAX_GUESS_ERROR;
+    }
+    if (!refined){
+        solvePose(orientations, corners, cameraMatrix, distCoeffs, rvec, tvec);
     }
+    guess.sequence = sequence;
+    guess.rvec = rvec;
+    guess.tvec = tvec;
+}
+
+void MarkerDetection::estimatePoses(const MarkerDict& dict, const vector<MarkerResult>& markers, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, vector<cv::Vec3d>& rvecs, vector<cv::Vec3d>& tvecs){
+    // put the corners of every marker in the order of the unit square, the orientation tells which corner is which
+    vector<cv::Point2f>& corners = buffers.poseBatch.corners;
+    corners.resize(markers.size() * 4);
+    for (int i = 0; i < markers.size(); i++){
+        const vector<cv::Point3f>& orientations = dict.orientations[markers[i].index];
+        for (int c = 0; c < 4; c++){
+            const cv::Point3f& o = orientations[c];
+            int j = o.y < 0.5f ? (o.x < 0.5f ? 0 : 1) : (o.x < 0.5f ? 3 : 2);
+            corners[i * 4 + j] = markers[i].corners[c];
+        }
+    }
+    PoseBatch::solve(corners, cameraMatrix, distCoeffs, buffers.poseBatch, rvecs, tvecs);
+}
+
+double MarkerDetection::reprojectionError(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const cv::Vec3d& rvec, const cv::Vec3d& tvec){
+    cv::Point2f projected[4];
+    cv::Mat projectedMat(4, 1, CV_32FC2, projected);
+    cv::projectPoints(orientations, rvec, tvec, cameraMatrix, distCoeffs, projectedMat);
+    double sum = 0;
+    for (int i = 0; i < 4; i++){
+        cv::Point2f d = projected[i] - corners[i];
+        sum += d.x * d.x + d.y * d.y;
+    }
+    return sqrt(sum / 4);
+}
+
+void MarkerDetection::projectCube(const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, vector<cv::Point2f>& projectedPoints){
+    // object points, which are the 3d points of the marker
+    static const vector<cv::Point3f> axis {cv::Point3f{0, 0, 0}, cv::Point3f{1, 0, 0}, cv::Point3f{0, 1, 0}, cv::Point3f{0, 0, -1},
+        cv::Point3f{1, 1, 0}, cv::Point3f{1, 1, -1}, cv::Point3f{1, 0, -1}, cv::Point3f{0, 1, -1}};
 
-    // Finds an object pose from 3D-2D point correspondences, outputs rotation and translation vectors
-    cv::solvePnP(orientations, corners2f, cameraMatrix, distCoeffs, rvec, tvec);
     // project 3d points to an image plane, outputs an array of 2d image points
     cv::projectPoints(axis, rvec, tvec, cameraMatrix, distCoeffs, projectedPoints);
+}
 
-    return projectedPoints;
-}
\ No newline at end of file
+void MarkerDetection::poseEstimation(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, vector<cv::Point2f>& projectedPoints){
+    cv::Vec3d rvec; // rotation vector of the marker
+    cv::Vec3d tvec; // translation vector of the marker
+    solvePose(orientations, corners, cameraMatrix, distCoeffs, rvec, tvec);
+    projectCube(rvec, tvec, cameraMatrix, distCoeffs, projectedPoints);
+}
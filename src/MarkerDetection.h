@@ -1,20 +1,135 @@
+#pragma once
 #include <opencv2/opencv.hpp>
+#include "MarkerCode.h"
+#include "PoseBatch.h"
 
 using namespace std;
 
+/* What a marker image stands for in the room */
+enum MarkerObjectClass{
+    MARKER_UNUSED = 0,                          // in the dictionary, but nothing is drawn for it
+    MARKER_WALL = 1,                            // one corner of the room, type is the wall position 0-3
+    MARKER_FURNITURE = 2,                       // a piece of furniture, type is the furniture type 0-11
+};
+
+struct MarkerObject{
+    int32_t objectClass = MARKER_UNUSED;
+    int32_t type = -1;
+};
+
 struct MarkerDict{
-    vector<vector<int>> ids;
+    vector<uint64_t> codes;                     // bit-packed cells of every marker, 4 rotations per marker image
     vector<vector<cv::Point3f>> orientations;
+    vector<MarkerObject> objects;               // what every entry stands for, the same for the 4 rotations of an image
+    MarkerIndex index;                          // lookup of the closest code, built from codes
 };
 
 struct MarkerResult{
-    vector<cv::Point> corners;
+    vector<cv::Point2f> corners;                // clockwise from the top left corner, sub-pixel where they were refined or followed
     int index = -1;
 };
 
+/* The pose a detection thread last solved for a marker image, the starting point of its next solve */
+struct PoseGuess{
+    long long sequence = -1;                    // the frame the pose was solved in, -1 if there is none
+    cv::Vec3d rvec;
+    cv::Vec3d tvec;
+};
+
+/* Scratch buffers for decoding a single candidate, one set per decoding thread */
+struct DecodeBuffers{
+    cv::Mat warped;
+    cv::Mat warped_thresh;
+    cv::Mat eroded;
+};
+
+/* Scratch buffers the detector reuses from one frame to the next, each detection thread owns one set */
+struct DetectionBuffers{
+    cv::Mat frame_thresh;                       // inverted binary frame, see MarkerDetection::preprocess
+    cv::Mat frame_small;                        // greyscale frame on the search pyramid level, only when it is above 0
+    cv::Mat integral;                           // integral image of the searched greyscale frame, only read by the adaptive threshold
+    vector<vector<cv::Point>> contours;
+    vector<cv::Point> contour_poly_approx;
+    vector<vector<cv::Point2f>> candidates;
+    vector<vector<cv::Point2f>> region_candidates; // candidates collected over the search regions, see findContourAndSquareInRegions
+    vector<cv::Rect> regions;                   // search regions of the current frame between two full scans
+    vector<cv::Mat> pyramid;                    // optical flow pyramid of the current frame, see MarkerTracker::follow
+    vector<cv::Point2f> flow_points;            // followed corners of the current frame
+    vector<uchar> flow_status;
+    vector<float> flow_error;
+    vector<cv::Point2f> refined_corners;        // corners of all candidates during the sub-pixel refinement
+    vector<uint64_t> codes;                     // decoded code of every candidate
+    vector<DecodeBuffers> decode;               // one set per decoding thread
+    vector<uint8_t> distances;                  // Hamming distances of the current candidate for small dictionaries
+    vector<PoseGuess> poses;                    // last pose of every marker image (dictionary index / 4), see MarkerDetection::trackPose
+    PoseBatchBuffers poseBatch;                 // see MarkerDetection::estimatePoses
+    cv::Mat frame_undistorted;                  // remapped frame in the UNDISTORT_FRAME mode, swapped with the captured one
+    cv::Mat frame_bgr;                          // YUYV frames are converted before they are remapped
+    vector<cv::Point2f> corner_points[2];       // corners of all markers before and after undistortCorners
+    vector<MarkerResult> undistorted;           // the markers with undistorted corners, in the UNDISTORT_CORNERS mode
+};
+
 
 class MarkerDetection{
     public:
+        /**
+         * Converts a captured frame into the greyscale image all detection steps work on
+         * 
+         * Greyscale frames are used as they are, YUYV frames (2 channels, from the YUV capture mode)
+         * give their Y plane without any color conversion.
+         * 
+         * @param frame The BGR, BGRA, YUYV or greyscale frame
+         * @param frame_grey Receives the greyscale image, shares the data of frame if it already is greyscale
+         */
+        static void toGray(const cv::Mat& frame, cv::Mat& frame_grey);
+
+        /**
+         * Picks the pyramid level the marker contours are searched on
+         * 
+         * Every level halves the resolution, so the contour search gets about 4 times cheaper per level. The
+         * highest level is picked on which a marker of minMarkerSize pixels is still large enough to be found.
+         * 
+         * @param minMarkerSize The side length in pixels of the smallest marker that has to be detected, 0 for any size
+         * @return the pyramid level, 0 for the full resolution
+         */
+        static int searchLevel(int minMarkerSize);
+
+        /**
+         * Prepares a captured frame for detection: the greyscale image the markers are decoded from and the
+         * inverted binary image their contours are found in (dark pixels are white)
+         * 
+         * The global mode uses a fixed threshold. BGR frames go through ImageKernels::grayThresholdInv, a single
+         * pass producing both images, other frames are converted with toGray and then thresholded.
+         * The adaptive mode compares every pixel with the mean of its neighbourhood instead, which keeps the
+         * markers under uneven lighting. The integral image it reads the window sums from is a scratch buffer
+         * (buffers.integral), no later stage uses it.
+         * Above pyramid level 0, the binary image is made from the downscaled greyscale frame and is
+         * smaller than the greyscale image, which stays at full resolution.
+         * 
+         * @param frame The BGR, BGRA, YUYV or greyscale frame
+         * @param adaptive Whether to use the adaptive instead of the global threshold
+         * @param level The pyramid level of the binary image (see searchLevel)
+         * @param threads The number of stripes of the frame binarized in parallel in adaptive mode, 0 or less lets OpenCV split them
+         * @param frame_grey Receives the greyscale image (see toGray), can be frame itself if that is greyscale already
+         * @param buffers The scratch buffers, buffers.frame_thresh receives the inverted binary image
+         */
+        static void preprocess(const cv::Mat& frame, bool adaptive, int level, int threads, cv::Mat& frame_grey, DetectionBuffers& buffers);
+
+        /**
+         * Same as preprocess at pyramid level 0, but only converts the given regions of the frame
+         * 
+         * frame_grey and buffers.frame_thresh keep the full frame size, outside of the regions they hold
+         * whatever was there before. Used by MarkerTracker between its full frame scans.
+         * 
+         * @param frame The BGR, BGRA, YUYV or greyscale frame
+         * @param adaptive Whether to use the adaptive instead of the global threshold
+         * @param threads The number of stripes of a region binarized in parallel in adaptive mode, 0 or less lets OpenCV split them
+         * @param regions The regions to convert, inside the frame
+         * @param frame_grey Receives the greyscale image
+         * @param buffers The scratch buffers, buffers.frame_thresh receives the inverted binary image
+         */
+        static void preprocessRegions(const cv::Mat& frame, bool adaptive, int threads, const vector<cv::Rect>& regions, cv::Mat& frame_grey, DetectionBuffers& buffers);
+
         /**
          * Finds the contour of any 4 sided shape in the frame and returns the coordinates of the corners 
          * 
@@ -22,23 +137,77 @@ class MarkerDetection{
          * not convex, and touching the edge of the frame. Furthermore, it also sorts the corners in a 
          * clockwise order.
          * 
-         * @param frame The frame (an image/a single frame of a video) to find the contour in
-         * @return a vector of candidate markers. Each marker is a vector of 4 points (squares).
+         * @param frame_thresh The inverted binary frame (see preprocess) to find the contour in, it is only read
+         * @param buffers The scratch buffers, buffers.candidates receives the candidate markers. Each marker is a vector of 4 points (squares).
+         */
+        static void findContourAndSquare(const cv::Mat& frame_thresh, DetectionBuffers& buffers, bool debug);
+
+        /**
+         * Runs findContourAndSquare on each region of the binary frame
+         * 
+         * @param frame_thresh The inverted binary frame (see preprocessRegions)
+         * @param regions The regions to search, they must not overlap or a marker is found twice
+         * @param buffers The scratch buffers, buffers.candidates receives the squares of all regions in frame coordinates
+         */
+        static void findContourAndSquareInRegions(const cv::Mat& frame_thresh, const vector<cv::Rect>& regions, DetectionBuffers& buffers);
+
+        /**
+         * Moves the candidate corners found on a pyramid level onto the full resolution frame
+         * 
+         * The corners are scaled up and then refined with cv::cornerSubPix on the greyscale frame, so they
+         * end up as accurate as corners found at full resolution.
+         * 
+         * @param frame_grey The full resolution greyscale frame
+         * @param level The pyramid level the candidates were found on, above 0
+         * @param buffers The scratch buffers, the corners of buffers.candidates are replaced by the refined ones
          */
-        static vector<vector<cv::Point>> findContourAndSquare(cv::Mat frame, bool debug);
+        static void refineCorners(const cv::Mat& frame_grey, int level, DetectionBuffers& buffers);
 
         /**
          * Find the IDs of all the markers in the frame
          * 
          * Each marker is warped into a bits*bits image and is divded into sqrt(bits)*sqrt(bits) cells.
-         * The center value of each cell (black -> 0, white -> 1) makes up the ID of each marker.
+         * The center value of each cell (black -> 0, white -> 1) makes up the ID of each marker, packed
+         * into a MarkerCode (at most 64 cells).
          * 
-         * @param frame The image containing the marker
+         * @param frame_grey The greyscale image containing the marker
          * @param square_contour The contour of the marker
-         * @param bits The number of rows/columns in the square marker
-         * @return an ID vector of the marker
+         * @param bits The number of cells in the square marker
+         * @param buffers The scratch buffers for the warped marker
+         * @param code Receives the bit-packed ID of the marker
+         */
+        static void getIds(const cv::Mat& frame_grey, const vector<cv::Point2f>& square_contour, int bits, DecodeBuffers& buffers, uint64_t& code, bool debug);
+
+        /**
+         * Find the IDs of a marker by sampling the greyscale image directly
+         * 
+         * Same result as getIds, without warping the marker: the cell centers are mapped through the
+         * homography of the square and the image is sampled with bilinear interpolation (2x2 points per
+         * cell). The threshold lies halfway between the black border cells and the brightest inner cell.
+         * No image is allocated, so the cost per candidate is small and constant.
+         * 
+         * @param frame_grey The greyscale image containing the marker
+         * @param square_contour The contour of the marker, clockwise from the top left corner
+         * @param bits The number of cells in the square marker (at most 64)
+         * @param code Receives the bit-packed ID of the marker
          */
-        static vector<int> getIds(cv::Mat frame, vector<cv::Point> square_contour, int bits, bool debug);
+        static void sampleIds(const cv::Mat& frame_grey, const vector<cv::Point2f>& square_contour, int bits, uint64_t& code);
+
+        /**
+         * Lists the marker images in a directory
+         * 
+         * @param directory The directory containing the marker images
+         * @return the paths of the marker images in ascending order (marker0, marker1, marker2, ...)
+        */
+        static vector<string> listMarkerPaths(const string& directory);
+
+        /**
+         * Looks up what a marker image stands for in the room, by its file name
+         * 
+         * @param markerPath The path of the marker image
+         * @return the wall or furniture of the image, MARKER_UNUSED for an image that is not assigned
+        */
+        static MarkerObject markerObject(const string& markerPath);
 
         /**
          * Constructs a dictionary of markers
@@ -49,28 +218,149 @@ class MarkerDetection{
          * @param markerPaths A vector of paths to the marker images
          * @return a dictionary of markers
         */
-        static MarkerDict constructMarkerDictionary(vector<string> markerPaths);
+        static MarkerDict constructMarkerDictionary(const vector<string>& markerPaths);
 
         /**
          * Detects the markers in the frame
          * 
-         * @param frame The frame to detect the markers in
+         * Every candidate square is decoded with sampleIds (getIds in debug mode, for the debug windows)
+         * and matched to the single closest dictionary entry. The candidates can be
+         * decoded on several threads, the results are the same and in the same order as with one thread.
+         * 
+         * @param frame_grey The greyscale frame to detect the markers in
+         * @param frame_thresh The inverted binary image of the same frame, both come from preprocess
+         * @param level The pyramid level frame_thresh was made on (the one passed to preprocess). Above 0, the candidates
+         *              found on it are refined at full resolution (see refineCorners)
+         * @param dict The dictionary of markers
+         * @param error_threshold The maximum number of errors allowed when comparing the marker to the dictionary
+         * @param decodeThreads The number of threads decoding the candidates (cv::parallel_for_), always 1 in debug mode
+         * @param buffers The scratch buffers of the calling thread
+         * @param results Receives the detected markers
+         */
+        static void detectMarker(const cv::Mat& frame_grey, const cv::Mat& frame_thresh, int level, const MarkerDict& dict, int error_threshold, int decodeThreads, DetectionBuffers& buffers, vector<MarkerResult>& results, bool debug);
+
+        /**
+         * The second half of detectMarker: decodes buffers.candidates and matches them to the dictionary
+         * 
+         * @param frame_grey The greyscale frame the candidates were found in
          * @param dict The dictionary of markers
          * @param error_threshold The maximum number of errors allowed when comparing the marker to the dictionary
-         * @return a vector of detected markers
+         * @param decodeThreads The number of threads decoding the candidates (cv::parallel_for_), always 1 in debug mode
+         * @param buffers The scratch buffers of the calling thread, holding the candidates
+         * @param results Receives the detected markers
+         */
+        static void decodeCandidates(const cv::Mat& frame_grey, const MarkerDict& dict, int error_threshold, int decodeThreads, DetectionBuffers& buffers, vector<MarkerResult>& results, bool debug);
+
+        /**
+         * Takes the lens distortion out of the corners of all markers of a frame, with a single cv::undistortPoints
+         * 
+         * The corners stay in pixels of the same camera matrix, so the poses can then be solved without
+         * distortion coefficients. Cheaper than remapping the whole frame, and the markers are still
+         * detected and drawn on the captured frame.
+         * 
+         * @param markers The detected markers
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param buffers The scratch buffers of the calling thread
+         * @param undistorted Receives the markers with undistorted corners
+         */
+        static void undistortCorners(const vector<MarkerResult>& markers, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, vector<MarkerResult>& undistorted);
+
+        /**
+         * Solves the pose of a single marker from scratch
+         * 
+         * Uses the closed-form planar square solver (IPPE_SQUARE), no iterations and no starting pose needed.
+         * 
+         * @param orientations The orientations of the marker
+         * @param corners The corners of the marker
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param rvec Receives the rotation vector of the marker
+         * @param tvec Receives the translation vector of the marker, in marker side lengths
+         */
+        static void solvePose(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Vec3d& rvec, cv::Vec3d& tvec);
+
+        /**
+         * Refines a pose with the iterative solver, starting from the pose passed in (useExtrinsicGuess)
+         * 
+         * @param orientations The orientations of the marker
+         * @param corners The corners of the marker
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param rvec The starting rotation vector, receives the refined one
+         * @param tvec The starting translation vector, receives the refined one
+         * @return the reprojection error of the refined pose
+         */
+        static double refinePose(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, cv::Vec3d& rvec, cv::Vec3d& tvec);
+
+        /**
+         * Solves the pose of a marker, starting from the pose this thread solved for it in a recent frame
+         * 
+         * A marker without a recent pose, or whose refined pose doesn't fit its corners, is solved from
+         * scratch with solvePose. The result is kept in buffers.poses for the next frame.
+         * 
+         * @param index The dictionary index of the marker
+         * @param sequence The capture sequence number of the frame
+         * @param dict The dictionary of markers
+         * @param corners The corners of the marker
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param buffers The scratch buffers of the calling thread
+         * @param rvec Receives the rotation vector of the marker
+         * @param tvec Receives the translation vector of the marker
+         */
+        static void trackPose(int index, long long sequence, const MarkerDict& dict, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, cv::Vec3d& rvec, cv::Vec3d& tvec);
+
+        /**
+         * Solves the poses of all markers of a frame at once, in closed form (see PoseBatch)
+         * 
+         * Faster than trackPose once there are many markers, but without its iterative refinement the poses
+         * are a little less accurate. buffers.poseBatch keeps the poses for PoseBatch::projectCubes.
+         * 
+         * @param dict The dictionary of markers
+         * @param markers The detected markers
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param buffers The scratch buffers of the calling thread
+         * @param rvecs Receives the rotation vector of every marker
+         * @param tvecs Receives the translation vector of every marker
+         */
+        static void estimatePoses(const MarkerDict& dict, const vector<MarkerResult>& markers, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, DetectionBuffers& buffers, vector<cv::Vec3d>& rvecs, vector<cv::Vec3d>& tvecs);
+
+        /**
+         * Root mean square distance in pixels between the corners of a marker and its corners projected with a pose
+         * 
+         * @param orientations The orientations of the marker
+         * @param corners The corners of the marker
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param rvec The rotation vector of the marker
+         * @param tvec The translation vector of the marker
+         * @return the reprojection error
+         */
+        static double reprojectionError(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, const cv::Vec3d& rvec, const cv::Vec3d& tvec);
+
+        /**
+         * Projects the 8 points of the cube drawn on a marker
+         * 
+         * @param rvec The rotation vector of the marker
+         * @param tvec The translation vector of the marker
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients
+         * @param projectedPoints Receives the projected points of the marker
          */
-        static vector<MarkerResult> detectMarker(cv::Mat frame, MarkerDict dict, int error_threshold, bool debug);
+        static void projectCube(const cv::Vec3d& rvec, const cv::Vec3d& tvec, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, vector<cv::Point2f>& projectedPoints);
 
         /**
          * Estimates the pose of a single marker
          * 
-         * returns all 8 coordinates of the cube drawn on the marker
+         * returns all 8 coordinates of the cube drawn on the marker (solvePose followed by projectCube)
          * 
          * @param orientations The orientations of the marker
          * @param corners The corners of the marker
          * @param cameraMatrix The camera matrix
          * @param distCoeffs The distortion coefficients
-         * @return vector of projected points of the marker 
+         * @param projectedPoints Receives the projected points of the marker 
          */
-        static vector<cv::Point2f> poseEstimation(vector<cv::Point3f> orientations, vector<cv::Point> corners, cv::Mat cameraMatrix, cv::Mat distCoeffs);
+        static void poseEstimation(const vector<cv::Point3f>& orientations, const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, vector<cv::Point2f>& projectedPoints);
 };
\ No newline at end of file
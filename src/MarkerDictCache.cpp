@@ -0,0 +1,139 @@
+#include "MarkerDictCache.h"
+#include "MappedFile.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+static const uint32_t CACHE_VERSION = 2;
+static const int GRID_SIZE = 6;
+
+struct CacheHeader{
+    char magic[4];
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t count;
+    uint32_t gridSize;
+};
+
+// FNV-1a, good enough to notice that a marker image changed
+static void hashBytes(uint64_t& hash, const void* data, size_t size){
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++){
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+}
+
+/* ======================================== MARKERDICTCACHE ======================================== */
+
+uint64_t MarkerDictCache::hashMarkerImages(const vector<string>& markerPaths){
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hashBytes(hash, &CACHE_VERSION, sizeof(CACHE_VERSION));
+    for (const string& path : markerPaths){
+        error_code error;
+        uintmax_t size = filesystem::file_size(path, error);
+        long long modified = filesystem::last_write_time(path, error).time_since_epoch().count();
+
+        string name = filesystem::path(path).filename().string();
+        MarkerObject object = MarkerDetection::markerObject(path);
+        hashBytes(hash, name.data(), name.size());
+        hashBytes(hash, &size, sizeof(size));
+        hashBytes(hash, &modified, sizeof(modified));
+        hashBytes(hash, &object, sizeof(object));
+    }
+    return hash;
+}
+
+bool MarkerDictCache::load(const string& cachePath, uint64_t sourceHash, MarkerDict& dict){
+    MappedFile file(cachePath);
+    if (!file.data || file.size < sizeof(CacheHeader)){
+        return false;
+    }
+
+    CacheHeader header;
+    memcpy(&header, file.data, sizeof(header));
+    if (memcmp(header.magic, "ARMD", 4) != 0 || header.version != CACHE_VERSION || header.sourceHash != sourceHash || header.gridSize != GRID_SIZE){
+        return false;
+    }
+    size_t codesSize = header.count * sizeof(uint64_t);
+    size_t orientationsSize = header.count * 4 * 3 * sizeof(float);
+    size_t objectsSize = header.count * sizeof(MarkerObject);
+    if (file.size != sizeof(header) + codesSize + orientationsSize + objectsSize){
+        return false;
+    }
+
+    // the dictionary is a few kilobytes, copying it out of the mapping is cheaper than keeping the mapping around
+    const unsigned char* codes = file.data + sizeof(header);
+    const float* orientations = (const float*)(codes + codesSize);
+    dict.codes.resize(header.count);
+    memcpy(dict.codes.data(), codes, codesSize);
+    dict.orientations.assign(header.count, vector<cv::Point3f>(4));
+    for (uint32_t i = 0; i < header.count; i++){
+        for (int j = 0; j < 4; j++){
+            const float* corner = orientations + (i * 4 + j) * 3;
+            dict.orientations[i][j] = cv::Point3f(corner[0], corner[1], corner[2]);
+        }
+    }
+    dict.objects.resize(header.count);
+    memcpy(dict.objects.data(), (const unsigned char*)orientations + orientationsSize, objectsSize);
+    dict.index.build(dict.codes);
+    return true;
+}
+
+bool MarkerDictCache::save(const string& cachePath, uint64_t sourceHash, const MarkerDict& dict){
+    CacheHeader header;
+    memcpy(header.magic, "ARMD", 4);
+    header.version = CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.count = dict.codes.size();
+    header.gridSize = GRID_SIZE;
+
+    vector<float> orientations;
+    orientations.reserve(dict.orientations.size() * 4 * 3);
+    for (const vector<cv::Point3f>& corners : dict.orientations){
+        for (const cv::Point3f& corner : corners){
+            orientations.push_back(corner.x);
+            orientations.push_back(corner.y);
+            orientations.push_back(corner.z);
+        }
+    }
+
+    // write next to the cache and swap it in, so a crash never leaves a half written cache behind
+    string tmpPath = cachePath + ".tmp";
+    {
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)dict.codes.data(), dict.codes.size() * sizeof(uint64_t));
+        out.write((const char*)orientations.data(), orientations.size() * sizeof(float));
+        out.write((const char*)dict.objects.data(), dict.objects.size() * sizeof(MarkerObject));
+        if (!out){
+            return false;
+        }
+    }
+    error_code error;
+    filesystem::rename(tmpPath, cachePath, error);
+    return !error;
+}
+
+MarkerDict MarkerDictCache::loadOrBuild(const string& markerDirectory, const string& cachePath){
+    vector<string> markerPaths = MarkerDetection::listMarkerPaths(markerDirectory);
+    uint64_t sourceHash = hashMarkerImages(markerPaths);
+
+    MarkerDict dict;
+    if (load(cachePath, sourceHash, dict)){
+        cout << "[prog] loaded dictionary from " << cachePath << endl;
+        return dict;
+    }
+
+    cout << "[prog] constructing dictionary for markers:" << endl;
+    dict = MarkerDetection::constructMarkerDictionary(markerPaths);
+    if (save(cachePath, sourceHash, dict)){
+        cout << "[prog] saved dictionary to " << cachePath << endl;
+    } else {
+        cout << "[prog] could not save dictionary to " << cachePath << endl;
+    }
+    return dict;
+}
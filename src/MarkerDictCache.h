@@ -0,0 +1,60 @@
+#pragma once
+#include "MarkerDetection.h"
+
+using namespace std;
+
+/**
+ * Binary cache of a constructed marker dictionary
+ *
+ * Building the dictionary decodes and warps every marker image. The result is written once to a
+ * compact file and memory-mapped on later launches instead. The file layout is
+ *
+ *      header      magic "ARMD", format version, source hash, number of codes, grid size
+ *      codes       uint64_t per dictionary entry
+ *      orientations 4 corners * (x, y, z) as float per dictionary entry
+ *      objects     class and type as int32_t per dictionary entry, the wall or furniture drawn for it
+ *
+ * The source hash covers the name, size and modification time of every marker image and the object it
+ * stands for, so the file is rebuilt as soon as an image is added, removed, replaced or assigned to
+ * another object.
+*/
+class MarkerDictCache{
+    public:
+        /**
+         * Hashes the marker images a dictionary is built from
+         *
+         * @param markerPaths The sorted paths of the marker images
+         * @return the hash stored in the cache file
+        */
+        static uint64_t hashMarkerImages(const vector<string>& markerPaths);
+
+        /**
+         * Reads the dictionary from the cache file
+         *
+         * @param cachePath The path of the cache file
+         * @param sourceHash The hash of the current marker images
+         * @param dict Receives the dictionary, including its index
+         * @return false if there is no cache file or it is outdated or damaged
+        */
+        static bool load(const string& cachePath, uint64_t sourceHash, MarkerDict& dict);
+
+        /**
+         * Writes the dictionary to the cache file, replacing it atomically
+         *
+         * @param cachePath The path of the cache file
+         * @param sourceHash The hash of the marker images the dictionary was built from
+         * @param dict The dictionary
+         * @return false if the file could not be written
+        */
+        static bool save(const string& cachePath, uint64_t sourceHash, const MarkerDict& dict);
+
+        /**
+         * Loads the dictionary of the marker images in a directory from the cache file, and rebuilds
+         * and saves it first if the cache is missing or the images changed
+         *
+         * @param markerDirectory The directory containing the marker images
+         * @param cachePath The path of the cache file, outside of markerDirectory
+         * @return the dictionary
+        */
+        static MarkerDict loadOrBuild(const string& markerDirectory, const string& cachePath);
+};
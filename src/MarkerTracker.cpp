@@ -0,0 +1,204 @@
+#include "MarkerTracker.h"
+
+using namespace std;
+
+// padding around the predicted quad, relative to its size plus a fixed margin for small markers
+static const float REGION_PADDING = 0.25f;
+static const int REGION_MARGIN = 8;
+
+// Lucas-Kanade window and pyramid depth, the frames the flow spans can be a few apart with several workers
+static const cv::Size FLOW_WINDOW(21, 21);
+static const int FLOW_LEVELS = 3;
+// mean absolute difference of the window around a corner between both frames, above it the corner is lost
+static const float MAX_FLOW_ERROR = 20.0f;
+
+static cv::Point2f center(const vector<cv::Point2f>& corners){
+    cv::Point2f sum(0, 0);
+    for (const cv::Point2f& corner : corners){
+        sum += corner;
+    }
+    return sum / (float)corners.size();
+}
+
+MarkerTracker::MarkerTracker(int keyframeInterval, bool opticalFlow)
+    : keyframeInterval(keyframeInterval), opticalFlow(opticalFlow), stateSequence(-1), lastKeyframe(-1), lost(false){
+}
+
+bool MarkerTracker::usesOpticalFlow() const{
+    return opticalFlow;
+}
+
+bool MarkerTracker::fullScanDue(long long sequence){
+    if (keyframeInterval <= 1 || stateSequence < 0 || lost || lastKeyframe < 0 || sequence - lastKeyframe >= keyframeInterval){
+        lastKeyframe = sequence;
+        lost = false;
+        return true;
+    }
+    return false;
+}
+
+bool MarkerTracker::plan(long long sequence, cv::Size frameSize, vector<cv::Rect>& regions){
+    lock_guard<mutex> lock(stateMutex);
+    regions.clear();
+    if (fullScanDue(sequence)){
+        return true;
+    }
+
+    // predict every quad from its last position and velocity, the further back that frame is the larger the region
+    const cv::Rect frameRect(cv::Point(0, 0), frameSize);
+    float age = (float)max(sequence - stateSequence, 1LL);
+    for (const TrackedMarker& marker : tracked){
+        cv::Rect quad = cv::boundingRect(marker.corners);
+        cv::Point2f shift = marker.velocity * age;
+        int padding = cvRound(max(quad.width, quad.height) * REGION_PADDING + REGION_MARGIN
+                              + 0.5f * (abs(marker.velocity.x) + abs(marker.velocity.y)) * age);
+        cv::Rect region(quad.x + cvRound(shift.x) - padding, quad.y + cvRound(shift.y) - padding,
+                        quad.width + 2 * padding, quad.height + 2 * padding);
+        region &= frameRect;
+        if (region.area() > 0){
+            regions.push_back(region);
+        }
+    }
+
+    // merge overlapping regions, a marker in the overlap would be found twice otherwise
+    // a grown region can overlap regions before it, so the pass repeats until nothing merges
+    bool merged = true;
+    while (merged){
+        merged = false;
+        for (size_t i = 0; i < regions.size(); i++){
+            for (size_t j = i + 1; j < regions.size(); j++){
+                if ((regions[i] & regions[j]).area() > 0){
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    j = i;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool MarkerTracker::follow(long long sequence, const cv::Mat& frame_grey, DetectionBuffers& buffers, vector<MarkerResult>& results){
+    shared_ptr<FlowState> state;
+    {
+        lock_guard<mutex> lock(stateMutex);
+        if (fullScanDue(sequence) || !flowState){
+            return false;
+        }
+        state = flowState;
+    }
+
+    cv::buildOpticalFlowPyramid(frame_grey, buffers.pyramid, FLOW_WINDOW, FLOW_LEVELS, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+    results.resize(state->indices.size());
+    if (state->indices.empty()){
+        // nothing to follow, new markers are found by the next full scan
+        return true;
+    }
+
+    static const cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 0.03);
+    vector<cv::Point2f>& points = buffers.flow_points;
+    cv::calcOpticalFlowPyrLK(state->pyramid, buffers.pyramid, state->corners, points, buffers.flow_status, buffers.flow_error,
+                             FLOW_WINDOW, FLOW_LEVELS, criteria);
+
+    for (int i = 0; i < (int)results.size(); i++){
+        MarkerResult& res = results[i];
+        res.index = state->indices[i];
+        res.corners.resize(4);
+        for (int j = 0; j < 4; j++){
+            int k = i * 4 + j;
+            if (!buffers.flow_status[k] || buffers.flow_error[k] > MAX_FLOW_ERROR){
+                return false;
+            }
+            res.corners[j] = points[k];
+        }
+        // the same shape checks as for a detected square
+        cv::Rect r = cv::boundingRect(res.corners);
+        if (!cv::isContourConvex(res.corners) || cv::contourArea(res.corners) < 100
+            || r.x <= 0 || r.y <= 0 || r.x + r.width >= frame_grey.cols || r.y + r.height >= frame_grey.rows){
+            return false;
+        }
+    }
+    return true;
+}
+
+void MarkerTracker::update(long long sequence, bool fullScan, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, DetectionBuffers& buffers){
+    if (opticalFlow){
+        updateFlow(sequence, fullScan, frame_grey, markers, buffers);
+    } else {
+        updateRegions(sequence, fullScan, markers);
+    }
+}
+
+void MarkerTracker::updateFlow(long long sequence, bool fullScan, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, DetectionBuffers& buffers){
+    // after a full scan the pyramid of the frame hasn't been built yet, build it before taking the lock
+    if (fullScan){
+        cv::buildOpticalFlowPyramid(frame_grey, buffers.pyramid, FLOW_WINDOW, FLOW_LEVELS, true, cv::BORDER_REFLECT_101, cv::BORDER_CONSTANT, false);
+    }
+
+    lock_guard<mutex> lock(stateMutex);
+    if (sequence <= stateSequence){
+        return;
+    }
+
+    // reuse a state no worker is reading any more, the one that is current can still be picked up
+    shared_ptr<FlowState> state;
+    for (shared_ptr<FlowState>& pooled : flowPool){
+        if (pooled != flowState && pooled.use_count() == 1){
+            state = pooled;
+            break;
+        }
+    }
+    if (!state){
+        state = make_shared<FlowState>();
+        flowPool.push_back(state);
+    }
+
+    state->sequence = sequence;
+    // the pyramid is handed over, the buffers get the memory of the old state in return
+    state->pyramid.swap(buffers.pyramid);
+    state->indices.resize(markers.size());
+    state->corners.resize(markers.size() * 4);
+    for (int i = 0; i < (int)markers.size(); i++){
+        state->indices[i] = markers[i].index;
+        copy(markers[i].corners.begin(), markers[i].corners.end(), state->corners.begin() + i * 4);
+    }
+    flowState = state;
+    stateSequence = sequence;
+}
+
+void MarkerTracker::updateRegions(long long sequence, bool fullScan, const vector<MarkerResult>& markers){
+    lock_guard<mutex> lock(stateMutex);
+    if (sequence <= stateSequence){
+        return;
+    }
+
+    // a marker that left its region is only found again by a full scan
+    if (!fullScan){
+        for (const TrackedMarker& marker : tracked){
+            bool found = false;
+            for (const MarkerResult& res : markers){
+                found = found || res.index == marker.index;
+            }
+            lost = lost || !found;
+        }
+    }
+
+    float frames = stateSequence < 0 ? 1.0f : (float)(sequence - stateSequence);
+    // fill the list of the state before last and swap, so both keep their memory
+    vector<TrackedMarker>& next = nextTracked;
+    next.resize(markers.size());
+    for (int i = 0; i < (int)markers.size(); i++){
+        next[i].velocity = cv::Point2f(0, 0);
+        next[i].index = markers[i].index;
+        next[i].corners = markers[i].corners;
+        for (const TrackedMarker& previous : tracked){
+            if (previous.index == markers[i].index){
+                next[i].velocity = (center(markers[i].corners) - center(previous.corners)) / frames;
+                break;
+            }
+        }
+    }
+    tracked.swap(next);
+    stateSequence = sequence;
+}
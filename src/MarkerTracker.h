@@ -0,0 +1,109 @@
+#pragma once
+#include "MarkerDetection.h"
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+/* Last known position of a marker, in frame coordinates */
+struct TrackedMarker{
+    int index = -1;                 // dictionary index of the marker
+    vector<cv::Point2f> corners;    // corners in the frame it was last seen in
+    cv::Point2f velocity;           // movement of the center in pixels per frame
+};
+
+/* A frame the optical flow starts from: its image pyramid and the corners of its markers */
+struct FlowState{
+    long long sequence = -1;
+    vector<cv::Mat> pyramid;                    // cv::buildOpticalFlowPyramid of the greyscale frame
+    vector<int> indices;                        // dictionary index of every marker
+    vector<cv::Point2f> corners;                // 4 corners per marker, kept sub-pixel so the rounding doesn't add up
+};
+
+/**
+ * Avoids the full detection between two full frame scans (keyframes) by following the markers found earlier
+ *
+ * A full scan runs every keyframeInterval frames, and on the next frame after a tracked marker has been
+ * lost. New markers therefore show up on the next keyframe at the latest. In between, there are two modes:
+ *
+ *      regions         every frame is only binarized and searched in a padded region around the predicted
+ *                      quad of each tracked marker (plan)
+ *      optical flow    the corners are carried forward with pyramidal Lucas-Kanade, the markers keep their
+ *                      identity so nothing is decoded (follow)
+ *
+ * The tracker is shared by all detection workers. With several workers the frames finish out of order,
+ * a frame then starts from the newest frame that has finished, so the regions grow with the number of
+ * frames in between and the optical flow spans several frames.
+*/
+class MarkerTracker{
+    public:
+        /**
+         * @param keyframeInterval The number of frames from one full frame scan to the next, 0 or 1 scans every frame
+         * @param opticalFlow Whether to follow the markers with optical flow instead of searching regions
+        */
+        MarkerTracker(int keyframeInterval, bool opticalFlow);
+
+        /* Whether the optical flow mode is used, then follow has to be called instead of plan */
+        bool usesOpticalFlow() const;
+
+        /**
+         * Decides how a frame is searched, in the region mode
+         *
+         * @param sequence The capture sequence number of the frame
+         * @param frameSize The size of the frame
+         * @param regions Receives the regions to search, merged so that they don't overlap
+         * @return true for a full frame scan, regions is left empty then
+        */
+        bool plan(long long sequence, cv::Size frameSize, vector<cv::Rect>& regions);
+
+        /**
+         * Carries the markers of an earlier frame over to this frame with optical flow, in the optical flow mode
+         *
+         * Fails when a full scan is due, or as soon as one corner can't be followed: the flow lost it or
+         * its residual is too high, or its quad is no longer a convex square inside the frame.
+         *
+         * @param sequence The capture sequence number of the frame
+         * @param frame_grey The greyscale frame
+         * @param buffers The scratch buffers, buffers.pyramid receives the pyramid of the frame
+         * @param results Receives the followed markers
+         * @return false if the frame needs a full detection
+        */
+        bool follow(long long sequence, const cv::Mat& frame_grey, DetectionBuffers& buffers, vector<MarkerResult>& results);
+
+        /**
+         * Takes the markers found in a frame as the new tracked state
+         *
+         * Results of frames older than the current state are ignored. After a region search, a
+         * marker that was tracked but not found again forces a full scan of the next frame.
+         *
+         * @param sequence The capture sequence number of the frame
+         * @param fullScan Whether the frame was scanned completely (the return value of plan, or false if follow succeeded)
+         * @param frame_grey The greyscale frame, only used in the optical flow mode
+         * @param markers The markers found in the frame
+         * @param buffers The scratch buffers of the frame, in the optical flow mode its pyramid is taken over
+        */
+        void update(long long sequence, bool fullScan, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, DetectionBuffers& buffers);
+
+    private:
+        // whether the frame has to be scanned completely, called with the mutex held
+        bool fullScanDue(long long sequence);
+        void updateRegions(long long sequence, bool fullScan, const vector<MarkerResult>& markers);
+        void updateFlow(long long sequence, bool fullScan, const cv::Mat& frame_grey, const vector<MarkerResult>& markers, DetectionBuffers& buffers);
+
+        int keyframeInterval;
+        bool opticalFlow;
+
+        mutex stateMutex;
+        long long stateSequence;        // the frame the tracked markers come from, -1 before the first one
+        long long lastKeyframe;         // the last frame planned as a full scan
+        bool lost;                      // a tracked marker went missing, scan the next frame completely
+
+        // region mode
+        vector<TrackedMarker> tracked;
+        vector<TrackedMarker> nextTracked;
+
+        // optical flow mode, the workers read the current state without holding the mutex, so a state is never
+        // changed once it is current; old states are reused once no worker holds them any more
+        shared_ptr<FlowState> flowState;
+        vector<shared_ptr<FlowState>> flowPool;
+};
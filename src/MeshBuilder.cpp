@@ -0,0 +1,39 @@
+#include "MeshBuilder.h"
+
+using namespace std;
+
+void MeshBuilder::begin(GLenum mode){
+    this->mode = mode;
+    primitive.clear();
+}
+
+void MeshBuilder::color(GLfloat r, GLfloat g, GLfloat b){
+    currentColor[0] = r;
+    currentColor[1] = g;
+    currentColor[2] = b;
+}
+
+void MeshBuilder::vertex(const cv::Point3f& position){
+    MeshVertex v = {{position.x, position.y, position.z}, {currentColor[0], currentColor[1], currentColor[2]}};
+    primitive.push_back(v);
+}
+
+void MeshBuilder::end(){
+    if (mode == GL_QUADS){
+        // a b c d --> a b c, a c d
+        for (size_t i = 0; i + 3 < primitive.size(); i += 4){
+            const MeshVertex* q = &primitive[i];
+            vertices.insert(vertices.end(), {q[0], q[1], q[2], q[0], q[2], q[3]});
+        }
+    } else if (mode == GL_POLYGON){
+        // the polygons are convex, a fan around the first vertex covers them
+        for (size_t i = 1; i + 1 < primitive.size(); i++){
+            vertices.insert(vertices.end(), {primitive[0], primitive[i], primitive[i + 1]});
+        }
+    } else if (mode == GL_LINES){
+        lines.insert(lines.end(), primitive.begin(), primitive.begin() + primitive.size() / 2 * 2);
+    } else {
+        vertices.insert(vertices.end(), primitive.begin(), primitive.begin() + primitive.size() / 3 * 3);
+    }
+    primitive.clear();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <GL/glew.h>
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+/* A vertex of the furniture meshes, in the layout of the vertex buffer */
+struct MeshVertex{
+    GLfloat position[3];        // marker space, in marker side lengths
+    GLfloat color[3];
+};
+
+/**
+ * Records glBegin / glColor3f / glVertex / glEnd style drawing as a triangle list
+ *
+ * The furniture compiler emits the faces of its models through it, and the walls are rebuilt with it every
+ * frame, ready to be uploaded into a vertex buffer. GL_QUADS and GL_POLYGON are split into triangles.
+*/
+class MeshBuilder{
+    public:
+        vector<MeshVertex> vertices;    // every three make a triangle
+        vector<MeshVertex> lines;       // every two make a line, from GL_LINES
+
+        /**
+         * Starts a primitive, like glBegin
+         *
+         * @param mode GL_TRIANGLES, GL_QUADS, GL_POLYGON or GL_LINES
+        */
+        void begin(GLenum mode);
+
+        /* Sets the color of the following vertices, like glColor3f */
+        void color(GLfloat r, GLfloat g, GLfloat b);
+
+        /* Adds a vertex in marker space, like glVertex3f */
+        void vertex(const cv::Point3f& position);
+
+        /* Ends the primitive, like glEnd */
+        void end();
+
+    private:
+        GLenum mode = GL_TRIANGLES;
+        GLfloat currentColor[3] = {1, 1, 1};
+        vector<MeshVertex> primitive;   // the vertices since begin
+};
@@ -1,4 +1,9 @@
 #include "ObjectRender.h"
+#include "FrameStats.h"
+#include <cstddef>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
 
 using namespace std;
 
@@ -18,3346 +23,672 @@ cv::Point2f ObjectRender::vectorAddRelative(cv::Point2f a, cv::Point2f b, cv::Po
     return c;
 }
 
-vector<cv::Point2f> ObjectRender::convertToGLCoords(vector<cv::Point2f> projectedPoints, int frame_width, int frame_height){
-    vector<cv::Point2f> points2D;
+cv::Point3f ObjectRender::vectorAddRelative(cv::Point3f a, cv::Point3f b, cv::Point3f origin, float scaleA, float scaleB){
+    // the y flip of the 2D version cancels out, what is left is origin + scaleA * (a - origin) + scaleB * (b - origin)
+    return origin + scaleA * (a - origin) + scaleB * (b - origin);
+}
+
+void ObjectRender::convertToGLCoords(const cv::Point2f* projectedPoints, int count, int frame_width, int frame_height, vector<cv::Point2f>& points2D){
+    points2D.resize(count);
     // convert the points from OpenCV coordinate space to OpenGL coordinate space, x and y are in [-1, 1]
-    for (const auto & point : projectedPoints){
-        float x = point.x/frame_width * 2.0f - 1.0f;
-        float y = point.y/frame_height * 2.0f - 1.0f;
-        points2D.push_back(cv::Point2f(x, y));
+    for (int i = 0; i < count; i++){
+        float x = projectedPoints[i].x/frame_width * 2.0f - 1.0f;
+        float y = projectedPoints[i].y/frame_height * 2.0f - 1.0f;
+        points2D[i] = cv::Point2f(x, y);
     }
-    return points2D;
 }
 
-vector<string> ObjectRender::sortWallMarker(map<string, vector<cv::Point2f>> wallMarkers, int frame_height){
-    vector<string> sortedMarkers;
-
-    // calculate metric for sorting based on the Y value of the marker
-    float topLeftA = frame_height-wallMarkers["topLeft"][0].y;
-    float topRightA = frame_height-wallMarkers["topRight"][0].y;
-    float bottomRightA = frame_height-wallMarkers["bottomRight"][0].y;
-    float bottomLeftA = frame_height-wallMarkers["bottomLeft"][0].y;
+void ObjectRender::sortWallMarker(const map<string, vector<cv::Point3f>>& wallMarkers, vector<string>& sortedMarkers){
+    // the corners are in camera space, z is the distance along the viewing direction
+    float topLeftA = wallMarkers.at("topLeft")[0].z;
+    float topRightA = wallMarkers.at("topRight")[0].z;
+    float bottomRightA = wallMarkers.at("bottomRight")[0].z;
+    float bottomLeftA = wallMarkers.at("bottomLeft")[0].z;
 
     // sort the markers in ascending order (closest --> farthest)
-    vector<pair<string, float>> markerAreas = {{"topLeft", topLeftA}, {"topRight", topRightA}, {"bottomRight", bottomRightA}, {"bottomLeft", bottomLeftA}};
-    sort(markerAreas.begin(), markerAreas.end(), [](const pair<string, float> &a, const pair<string, float> &b){
+    pair<const char*, float> markerAreas[4] = {{"topLeft", topLeftA}, {"topRight", topRightA}, {"bottomRight", bottomRightA}, {"bottomLeft", bottomLeftA}};
+    sort(markerAreas, markerAreas + 4, [](const pair<const char*, float> &a, const pair<const char*, float> &b){
         return a.second < b.second;
     });
 
-    for (const auto & marker : markerAreas){
-        sortedMarkers.push_back(marker.first);
+    sortedMarkers.resize(4);
+    for (int i = 0; i < 4; i++){
+        sortedMarkers[i] = markerAreas[i].first;
     }
-
-    return sortedMarkers;
 }
 
-// draw two walls, connecting the farthest and its neighbors. color is a triple of (r, g, b) -->  [0]: floor, [1] left, [2]: right, [3]: roof
-void ObjectRender::drawWalls(map<string, vector<cv::Point2f>> wallMarkerCorners, vector<string> sortedKeyClosest, vector<vector<GLfloat>> colors, bool outline = true, bool floor = true, float extraHeight = 0.0){
-    vector<string> sortedKeyClosest1 = sortedKeyClosest;
-
-    string furthest = sortedKeyClosest[3];
-    string neighbor1 = sortedKeyClosest[2];
-    string neighbor2 = sortedKeyClosest[1];
-    string closest = sortedKeyClosest[0];
+// build two walls, connecting the farthest and its neighbors. color is a triple of (r, g, b) -->  [0]: floor, [1] left, [2]: right, [3]: roof
+void ObjectRender::buildWalls(const map<string, vector<cv::Point3f>>& wallMarkerCorners, const vector<string>& sortedKeyClosest, const vector<vector<GLfloat>>& colors, bool outline, bool floor, float extraHeight, MeshBuilder& mesh){
+    // local copies of the corners, the thickness and height of the walls are adjusted on them
+    cv::Point3f furthest[8];
+    cv::Point3f neighbor1[8];
+    cv::Point3f neighbor2[8];
+    cv::Point3f closest[8];
+    copy(wallMarkerCorners.at(sortedKeyClosest[3]).begin(), wallMarkerCorners.at(sortedKeyClosest[3]).begin() + 8, furthest);
+    copy(wallMarkerCorners.at(sortedKeyClosest[2]).begin(), wallMarkerCorners.at(sortedKeyClosest[2]).begin() + 8, neighbor1);
+    copy(wallMarkerCorners.at(sortedKeyClosest[1]).begin(), wallMarkerCorners.at(sortedKeyClosest[1]).begin() + 8, neighbor2);
+    copy(wallMarkerCorners.at(sortedKeyClosest[0]).begin(), wallMarkerCorners.at(sortedKeyClosest[0]).begin() + 8, closest);
 
     // control the thickness of the walls
-    wallMarkerCorners[neighbor1][4] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][4], wallMarkerCorners[neighbor1][0], wallMarkerCorners[neighbor1][0], 0.25, 0.25);
-    wallMarkerCorners[neighbor2][4] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][4], wallMarkerCorners[neighbor2][0], wallMarkerCorners[neighbor2][0], 0.25, 0.25);
-    wallMarkerCorners[furthest][4] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][4], wallMarkerCorners[furthest][0], wallMarkerCorners[furthest][0], 0.25, 0.25);
-    wallMarkerCorners[neighbor1][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][3], wallMarkerCorners[neighbor1][4], wallMarkerCorners[neighbor1][0], 1, 1);
-    wallMarkerCorners[neighbor2][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][3], wallMarkerCorners[neighbor2][4], wallMarkerCorners[neighbor2][0], 1, 1);
-    wallMarkerCorners[furthest][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][3], wallMarkerCorners[furthest][4], wallMarkerCorners[furthest][0], 1, 1);
+    neighbor1[4] = ObjectRender::vectorAddRelative(neighbor1[4], neighbor1[0], neighbor1[0], 0.25, 0.25);
+    neighbor2[4] = ObjectRender::vectorAddRelative(neighbor2[4], neighbor2[0], neighbor2[0], 0.25, 0.25);
+    furthest[4] = ObjectRender::vectorAddRelative(furthest[4], furthest[0], furthest[0], 0.25, 0.25);
+    neighbor1[5] = ObjectRender::vectorAddRelative(neighbor1[3], neighbor1[4], neighbor1[0], 1, 1);
+    neighbor2[5] = ObjectRender::vectorAddRelative(neighbor2[3], neighbor2[4], neighbor2[0], 1, 1);
+    furthest[5] = ObjectRender::vectorAddRelative(furthest[3], furthest[4], furthest[0], 1, 1);
 
     // add extra height to the wall
-    wallMarkerCorners[neighbor1][3] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][0], wallMarkerCorners[neighbor1][3], wallMarkerCorners[neighbor1][0], 1, 1+extraHeight);
-    wallMarkerCorners[neighbor2][3] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][0], wallMarkerCorners[neighbor2][3], wallMarkerCorners[neighbor2][0], 1, 1+extraHeight);
-    wallMarkerCorners[furthest][3] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][0], wallMarkerCorners[furthest][3], wallMarkerCorners[furthest][0], 1, 1+extraHeight);
-    wallMarkerCorners[neighbor1][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][3], wallMarkerCorners[neighbor1][4], wallMarkerCorners[neighbor1][0], 1, 1);
-    wallMarkerCorners[neighbor2][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][3], wallMarkerCorners[neighbor2][4], wallMarkerCorners[neighbor2][0], 1, 1);
-    wallMarkerCorners[furthest][5] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][3], wallMarkerCorners[furthest][4], wallMarkerCorners[furthest][0], 1, 1);
-    wallMarkerCorners[neighbor1][6] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][3], wallMarkerCorners[neighbor1][1], wallMarkerCorners[neighbor1][0], 1, 1);
-    wallMarkerCorners[neighbor2][6] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][3], wallMarkerCorners[neighbor2][1], wallMarkerCorners[neighbor2][0], 1, 1);
-    wallMarkerCorners[furthest][6] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][3], wallMarkerCorners[furthest][1], wallMarkerCorners[furthest][0], 1, 1);
-    wallMarkerCorners[neighbor1][7] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor1][3], wallMarkerCorners[neighbor1][2], wallMarkerCorners[neighbor1][0], 1, 1);
-    wallMarkerCorners[neighbor2][7] = ObjectRender::vectorAddRelative(wallMarkerCorners[neighbor2][3], wallMarkerCorners[neighbor2][2], wallMarkerCorners[neighbor2][0], 1, 1);
-    wallMarkerCorners[furthest][7] = ObjectRender::vectorAddRelative(wallMarkerCorners[furthest][3], wallMarkerCorners[furthest][2], wallMarkerCorners[furthest][0], 1, 1);
+    neighbor1[3] = ObjectRender::vectorAddRelative(neighbor1[0], neighbor1[3], neighbor1[0], 1, 1+extraHeight);
+    neighbor2[3] = ObjectRender::vectorAddRelative(neighbor2[0], neighbor2[3], neighbor2[0], 1, 1+extraHeight);
+    furthest[3] = ObjectRender::vectorAddRelative(furthest[0], furthest[3], furthest[0], 1, 1+extraHeight);
+    neighbor1[5] = ObjectRender::vectorAddRelative(neighbor1[3], neighbor1[4], neighbor1[0], 1, 1);
+    neighbor2[5] = ObjectRender::vectorAddRelative(neighbor2[3], neighbor2[4], neighbor2[0], 1, 1);
+    furthest[5] = ObjectRender::vectorAddRelative(furthest[3], furthest[4], furthest[0], 1, 1);
+    neighbor1[6] = ObjectRender::vectorAddRelative(neighbor1[3], neighbor1[1], neighbor1[0], 1, 1);
+    neighbor2[6] = ObjectRender::vectorAddRelative(neighbor2[3], neighbor2[1], neighbor2[0], 1, 1);
+    furthest[6] = ObjectRender::vectorAddRelative(furthest[3], furthest[1], furthest[0], 1, 1);
+    neighbor1[7] = ObjectRender::vectorAddRelative(neighbor1[3], neighbor1[2], neighbor1[0], 1, 1);
+    neighbor2[7] = ObjectRender::vectorAddRelative(neighbor2[3], neighbor2[2], neighbor2[0], 1, 1);
+    furthest[7] = ObjectRender::vectorAddRelative(furthest[3], furthest[2], furthest[0], 1, 1);
     
 
     // draw floor
     if (floor){
-        glBegin(GL_QUADS);
+        mesh.begin(GL_QUADS);
         // 0.851,0.725,0.608
         // 0.678,0.58,0.486
-        glColor3f(0.678,0.58,0.486);
-        glVertex2f(wallMarkerCorners[furthest][0].x, -wallMarkerCorners[furthest][0].y);
-        glVertex2f(wallMarkerCorners[neighbor1][0].x, -wallMarkerCorners[neighbor1][0].y);
-        glVertex2f(wallMarkerCorners[closest][0].x, -wallMarkerCorners[closest][0].y);
-        glVertex2f(wallMarkerCorners[neighbor2][0].x, -wallMarkerCorners[neighbor2][0].y);
-        glEnd();
+        mesh.color(0.678,0.58,0.486);
+        mesh.vertex(furthest[0]);
+        mesh.vertex(neighbor1[0]);
+        mesh.vertex(closest[0]);
+        mesh.vertex(neighbor2[0]);
+        mesh.end();
     }
 
     
-    glBegin(GL_QUADS);
+    mesh.begin(GL_QUADS);
     // draw second closest to furthest floor
-    glColor3f(colors[0][0], colors[0][1], colors[0][2]);
-    glVertex2f(wallMarkerCorners[furthest][0].x, -wallMarkerCorners[furthest][0].y);
-    glVertex2f(wallMarkerCorners[neighbor1][0].x, -wallMarkerCorners[neighbor1][0].y);
-    glVertex2f(wallMarkerCorners[neighbor1][4].x, -wallMarkerCorners[neighbor1][4].y);
-    glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
+    mesh.color(colors[0][0], colors[0][1], colors[0][2]);
+    mesh.vertex(furthest[0]);
+    mesh.vertex(neighbor1[0]);
+    mesh.vertex(neighbor1[4]);
+    mesh.vertex(furthest[4]);
         // draw closest to furthest outer wall
-        glColor3f(colors[1][0], colors[1][1], colors[1][2]);
-        glVertex2f(wallMarkerCorners[neighbor1][0].x, -wallMarkerCorners[neighbor1][0].y);
-        glVertex2f(wallMarkerCorners[neighbor1][3].x, -wallMarkerCorners[neighbor1][3].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
-        glVertex2f(wallMarkerCorners[furthest][0].x, -wallMarkerCorners[furthest][0].y);
+        mesh.color(colors[1][0], colors[1][1], colors[1][2]);
+        mesh.vertex(neighbor1[0]);
+        mesh.vertex(neighbor1[3]);
+        mesh.vertex(furthest[3]);
+        mesh.vertex(furthest[0]);
         // draw closest to furthest inner wall
-        glColor3f(colors[2][0], colors[2][1], colors[2][2]);
-        glVertex2f(wallMarkerCorners[neighbor1][4].x, -wallMarkerCorners[neighbor1][4].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
+        mesh.color(colors[2][0], colors[2][1], colors[2][2]);
+        mesh.vertex(neighbor1[4]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[4]);
         // draw closest to furthest roof
-        glColor3f(colors[3][0], colors[3][1], colors[3][2]);
-        glVertex2f(wallMarkerCorners[neighbor1][3].x, -wallMarkerCorners[neighbor1][3].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
+        mesh.color(colors[3][0], colors[3][1], colors[3][2]);
+        mesh.vertex(neighbor1[3]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[3]);
         // draw closest to furthest wall cover
-        glColor3f(colors[1][0], colors[1][1], colors[1][2]);
-        glVertex2f(wallMarkerCorners[neighbor1][0].x, -wallMarkerCorners[neighbor1][0].y);
-        glVertex2f(wallMarkerCorners[neighbor1][4].x, -wallMarkerCorners[neighbor1][4].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[neighbor1][3].x, -wallMarkerCorners[neighbor1][3].y);
-    glEnd();
-
-    glBegin(GL_QUADS);
+        mesh.color(colors[1][0], colors[1][1], colors[1][2]);
+        mesh.vertex(neighbor1[0]);
+        mesh.vertex(neighbor1[4]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(neighbor1[3]);
+    mesh.end();
+
+    mesh.begin(GL_QUADS);
     // draw closest to furthest wall
-    glColor3f(colors[0][0], colors[0][1], colors[0][2]);
-    glVertex2f(wallMarkerCorners[furthest][0].x, -wallMarkerCorners[furthest][0].y);
-    glVertex2f(wallMarkerCorners[neighbor2][0].x, -wallMarkerCorners[neighbor2][0].y);
-    glVertex2f(wallMarkerCorners[neighbor2][4].x, -wallMarkerCorners[neighbor2][4].y);
-    glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
+    mesh.color(colors[0][0], colors[0][1], colors[0][2]);
+    mesh.vertex(furthest[0]);
+    mesh.vertex(neighbor2[0]);
+    mesh.vertex(neighbor2[4]);
+    mesh.vertex(furthest[4]);
         // draw closest to furthest outer wall
-        glColor3f(colors[2][0], colors[2][1], colors[2][2]);
-        glVertex2f(wallMarkerCorners[neighbor2][0].x, -wallMarkerCorners[neighbor2][0].y);
-        glVertex2f(wallMarkerCorners[neighbor2][3].x, -wallMarkerCorners[neighbor2][3].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
-        glVertex2f(wallMarkerCorners[furthest][0].x, -wallMarkerCorners[furthest][0].y);
+        mesh.color(colors[2][0], colors[2][1], colors[2][2]);
+        mesh.vertex(neighbor2[0]);
+        mesh.vertex(neighbor2[3]);
+        mesh.vertex(furthest[3]);
+        mesh.vertex(furthest[0]);
         // draw closest to furthest inner wall
-        glColor3f(colors[1][0], colors[1][1], colors[1][2]);
-        glVertex2f(wallMarkerCorners[neighbor2][4].x, -wallMarkerCorners[neighbor2][4].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
+        mesh.color(colors[1][0], colors[1][1], colors[1][2]);
+        mesh.vertex(neighbor2[4]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[4]);
         // draw closest to furthest roof
-        glColor3f(colors[3][0], colors[3][1], colors[3][2]);
-        glVertex2f(wallMarkerCorners[neighbor2][3].x, -wallMarkerCorners[neighbor2][3].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
+        mesh.color(colors[3][0], colors[3][1], colors[3][2]);
+        mesh.vertex(neighbor2[3]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[3]);
         // draw closest to furthest wall cover
-        glColor3f(colors[1][0], colors[1][1], colors[1][2]);
-        glVertex2f(wallMarkerCorners[neighbor2][0].x, -wallMarkerCorners[neighbor2][0].y);
-        glVertex2f(wallMarkerCorners[neighbor2][4].x, -wallMarkerCorners[neighbor2][4].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[neighbor2][3].x, -wallMarkerCorners[neighbor2][3].y);
-    glEnd();
+        mesh.color(colors[1][0], colors[1][1], colors[1][2]);
+        mesh.vertex(neighbor2[0]);
+        mesh.vertex(neighbor2[4]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(neighbor2[3]);
+    mesh.end();
 
     if (outline){
-        glBegin(GL_LINES);
+        mesh.begin(GL_LINES);
         // trace inner wall first
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[neighbor1][4].x, -wallMarkerCorners[neighbor1][4].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
-        glEnd();
-
-        glBegin(GL_LINES);
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(neighbor1[4]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[4]);
+        mesh.end();
+
+        mesh.begin(GL_LINES);
         // trace outer wall second
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[neighbor2][4].x, -wallMarkerCorners[neighbor2][4].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[furthest][4].x, -wallMarkerCorners[furthest][4].y);
-        glEnd();
-
-        glBegin(GL_LINES);
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(neighbor2[4]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(furthest[4]);
+        mesh.end();
+
+        mesh.begin(GL_LINES);
         // trace roof first
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
-        glVertex2f(wallMarkerCorners[neighbor1][3].x, -wallMarkerCorners[neighbor1][3].y);
-        glEnd();
-
-        glBegin(GL_LINES);
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(furthest[3]);
+        mesh.vertex(neighbor1[3]);
+        mesh.end();
+
+        mesh.begin(GL_LINES);
         // trace roof second
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[furthest][5].x, -wallMarkerCorners[furthest][5].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[furthest][3].x, -wallMarkerCorners[furthest][3].y);
-        glVertex2f(wallMarkerCorners[neighbor2][3].x, -wallMarkerCorners[neighbor2][3].y);
-        glEnd();
-
-        glBegin(GL_LINES);
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(furthest[5]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(furthest[3]);
+        mesh.vertex(neighbor2[3]);
+        mesh.end();
+
+        mesh.begin(GL_LINES);
         // trace wall cover first
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[neighbor1][0].x, -wallMarkerCorners[neighbor1][0].y);
-        glVertex2f(wallMarkerCorners[neighbor1][4].x, -wallMarkerCorners[neighbor1][4].y);
-        glVertex2f(wallMarkerCorners[neighbor1][5].x, -wallMarkerCorners[neighbor1][5].y);
-        glVertex2f(wallMarkerCorners[neighbor1][3].x, -wallMarkerCorners[neighbor1][3].y);
-        glEnd();
-
-        glBegin(GL_LINES);
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(neighbor1[0]);
+        mesh.vertex(neighbor1[4]);
+        mesh.vertex(neighbor1[5]);
+        mesh.vertex(neighbor1[3]);
+        mesh.end();
+
+        mesh.begin(GL_LINES);
         // trace wall cover second
-        glColor3f(0.0f, 0.0f, 0.0f);
-        glVertex2f(wallMarkerCorners[neighbor2][0].x, -wallMarkerCorners[neighbor2][0].y);
-        glVertex2f(wallMarkerCorners[neighbor2][4].x, -wallMarkerCorners[neighbor2][4].y);
-        glVertex2f(wallMarkerCorners[neighbor2][5].x, -wallMarkerCorners[neighbor2][5].y);
-        glVertex2f(wallMarkerCorners[neighbor2][3].x, -wallMarkerCorners[neighbor2][3].y);
-        glEnd();
+        mesh.color(0.0f, 0.0f, 0.0f);
+        mesh.vertex(neighbor2[0]);
+        mesh.vertex(neighbor2[4]);
+        mesh.vertex(neighbor2[5]);
+        mesh.vertex(neighbor2[3]);
+        mesh.end();
     }
 }
 
-void ObjectRender::drawTable1x1(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)5/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[2], projectedGLPoints[1], 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[0], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[2], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float)5/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[0], projectedGLPoints[4], 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[0], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[2], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[5], leg44, 0, (float)5/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)5/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    // table top
-    // table board 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // table board 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // table board 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glEnd();
-    // table board 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glEnd();
-    // table board top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
+// the models of resources/furniture.txt in the order of the furniture marker ids (16-19, 20-23, ...)
+static const char* const FURNITURE_NAMES[12] = {"table1x1", "table1x2", "basicChair", "bed", "smallSofa", "longSofa",
+    "tableForSofa", "diningTable", "diningChair", "tv", "carpet", "bookshelf"};
+
+// the unit cube of MarkerDetection::projectCube, z points away from the marker towards the camera side
+static const cv::Point3f UNIT_CUBE[8] = {cv::Point3f{0, 0, 0}, cv::Point3f{1, 0, 0}, cv::Point3f{0, 1, 0}, cv::Point3f{0, 0, -1},
+    cv::Point3f{1, 1, 0}, cv::Point3f{1, 1, -1}, cv::Point3f{1, 0, -1}, cv::Point3f{0, 1, -1}};
+
+// near and far plane of the depth test, in marker side lengths
+static const float NEAR_PLANE = 0.1f;
+static const float FAR_PLANE = 1000.0f;
+
+// shades that tell repeated pieces of one type apart, the first piece keeps the colors of the model
+static const GLfloat INSTANCE_TINTS[4][3] = {{1, 1, 1}, {0.85, 0.85, 0.85}, {1, 0.9, 0.8}, {0.8, 0.9, 1}};
+
+// the lens distortion of cv::projectPoints is applied to every vertex on the normalized image plane, before the projection
+static const char* MESH_VERTEX_SHADER = R"(
+#version 330 core
+uniform mat4 projection;
+uniform vec3 radial;        // k1 k2 k3
+uniform vec3 rational;      // k4 k5 k6
+uniform vec2 tangential;    // p1 p2
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 color;
+layout(location = 2) in mat4 modelView;     // locations 2 to 5, one per column
+layout(location = 6) in vec3 tint;
+out vec3 vertexColor;
+void main(){
+    vertexColor = color * tint;
+    vec4 eye = modelView * vec4(position, 1.0);
+    if (eye.z > 0.0){
+        vec2 n = eye.xy / eye.z;
+        float r2 = dot(n, n);
+        float k = (1.0 + r2 * (radial.x + r2 * (radial.y + r2 * radial.z))) / (1.0 + r2 * (rational.x + r2 * (rational.y + r2 * rational.z)));
+        vec2 t = vec2(2.0 * tangential.x * n.x * n.y + tangential.y * (r2 + 2.0 * n.x * n.x),
+                      tangential.x * (r2 + 2.0 * n.y * n.y) + 2.0 * tangential.y * n.x * n.y);
+        eye.xy = (n * k + t) * eye.z;
+    }
+    gl_Position = projection * eye;
 }
-
-void ObjectRender::drawTable1x2(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    // extending some points to lengthen the table
-    cv::Point2f extend6 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[6], projectedGLPoints[3], 0, 2);
-    cv::Point2f extend5 = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectedGLPoints[5], projectedGLPoints[7], 0, 2);
-    cv::Point2f extend1 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 2);
-    cv::Point2f extend4 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, 2);
-    
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)5/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(extend1, projectedGLPoints[2], extend1, 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[1], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, extend4, leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, extend6, leg11, 0, (float)5/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(extend4, projectedGLPoints[0], extend4, 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, extend1, leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[4], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, extend5, leg44, 0, (float)5/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)5/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    
-    // table top
-    // table board 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // table board 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // table board 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glEnd();
-    // table board 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(extend5.x, -extend5.y);
-    glEnd();
-    // table board top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
-
+)";
+
+static const char* MESH_FRAGMENT_SHADER = R"(
+#version 330 core
+in vec3 vertexColor;
+out vec4 fragColor;
+void main(){
+    fragColor = vec4(vertexColor, 1.0);
 }
-
-
-void ObjectRender::drawBasicChair(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)5/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[2], projectedGLPoints[1], 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[0], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[2], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float)5/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[0], projectedGLPoints[4], 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[0], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[2], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[5], leg44, 0, (float)5/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)5/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    
-    
-    // the board of the chair to sit on
-    // board 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // board 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // board 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glEnd();
-    // board 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glEnd();
-    // board top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
-    
-    // upper part of the chair to lean on
-    cv::Point2f new3 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, 2);
-    cv::Point2f new6 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, 2);
-    cv::Point2f new5_bottom = ObjectRender::vectorAddRelative(leg14, projectedGLPoints[6], leg11, 1, 1);
-    cv::Point2f new7_bottom = ObjectRender::vectorAddRelative(leg02, projectedGLPoints[3], leg00, 1, 1);
-    cv::Point2f new5_top = ObjectRender::vectorAddRelative(leg14, new5_bottom, leg14, 0, 2);
-    cv::Point2f new7_top = ObjectRender::vectorAddRelative(leg02, new7_bottom, leg02, 0, 2);
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    
-    // 3737
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-   
-    // 5656
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    
-    // 5757
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-    
-    // top
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glEnd();
-    
-
+)";
+
+// the camera frame on a triangle covering the screen, the top row of the frame at the top of the window
+static const char* FRAME_VERTEX_SHADER = R"(
+#version 330 core
+out vec2 texCoord;
+void main(){
+    vec2 position = vec2(gl_VertexID == 1 ? 3.0 : -1.0, gl_VertexID == 2 ? 3.0 : -1.0);
+    texCoord = vec2(position.x * 0.5 + 0.5, 0.5 - position.y * 0.5);
+    gl_Position = vec4(position, 0.0, 1.0);
 }
-
-void ObjectRender::drawBed(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-
-    // scalability
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1 - scale) / 2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1 - scale) / 2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1 - scale) / 2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1 - scale) / 2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1 - scale) / 2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1 - scale) / 2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1 - scale) / 2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1 - scale) / 2);
-
-    scale = 1.0;
-    // leg 0
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float) scale/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1.0, 1.0);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1.0, 1.0);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1.0, 1.0);
-    
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 1.0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[0], leg11, 0, (float)(scale / 6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[2], leg11, 0, (float)(scale / 6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale / 6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float) scale/ 6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1.0, 1.0);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1.0, 1.0);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1.0, 1.0);
-
-
-    // helper extensions
-    cv::Point2f corner44 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[4], projectedGLPoints[1], 0, 2);
-    cv::Point2f corner22 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[2], projectedGLPoints[0], 0, 2);
-    cv::Point2f corner77 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[7], projectedGLPoints[3], 0, 2);
-    cv::Point2f corner45 = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectedGLPoints[5], projectedGLPoints[6], 0, 2);
-    cv::Point2f xleg45 = ObjectRender::vectorAddRelative(corner44, projectedGLPoints[5], corner44, 0, (float) scale / 6);
-     
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[2], projectedGLPoints[0], 0, 2);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, leg00, leg22, 0, (float)(1.0 / 6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, corner44, leg22, 0, (float)(scale / 6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg24, leg01, leg24, 0, (float)(scale / 6));
-    
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, corner77, leg22, 0, (float) scale / 6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg07, leg27, 0, (float)scale / 6);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, xleg45, leg27, 0, (float)scale / 6);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg25, leg06, leg25, 0, (float)scale / 6);
-
-    // leg 4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[4], projectedGLPoints[1], 0, 2);
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale / 6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, corner22, leg44, 0, (float)(scale / 6));
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg42, leg10, leg42, 0, (float)(scale / 6));
-    
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, corner45, leg44, 0, (float)scale / 6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg16, leg45, 0, (float)scale / 6);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg27, leg45, 0, (float)scale / 6);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg47, leg13, leg47, 0, (float)scale / 6);
-    
-    // bed corners
-    cv::Point2f bed0 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, 3.0/6);
-    cv::Point2f bed1 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[6], projectedGLPoints[1], 0, 3.0/6);
-    cv::Point2f bed2 = ObjectRender::vectorAddRelative(leg22, corner77, leg22, 0, 3.0/6);
-    cv::Point2f bed4 = ObjectRender::vectorAddRelative(leg44, corner45, leg44, 0, 3.0/6);
-
-    // leg 0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-
-    // leg 1
-    glBegin(GL_QUADS);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    
-    // leg 2
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-
-    // leg 4
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-
-    // bed
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(bed0.x, -bed0.y);
-    glVertex2f(bed1.x, -bed1.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(bed4.x, -bed4.y);
-    glVertex2f(bed1.x, -bed1.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(bed2.x, -bed2.y);
-    glVertex2f(bed0.x, -bed0.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(bed2.x, -bed2.y);
-    glVertex2f(bed4.x, -bed4.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(bed0.x, -bed0.y);
-    glVertex2f(bed1.x, -bed1.y);
-    glVertex2f(bed4.x, -bed4.y);
-    glVertex2f(bed2.x, -bed2.y);
-    glEnd();
-
-    
-    // bed back
-    cv::Point2f back3 = projectedGLPoints[3];
-    cv::Point2f back6 = projectedGLPoints[6];
-    cv::Point2f back7 = ObjectRender::vectorAddRelative(back3, projectedGLPoints[7], back3, 0, 1.0 / 6);
-    cv::Point2f back5 = ObjectRender::vectorAddRelative(back6, projectedGLPoints[5], back6, 0, 1.0 / 6);
-
-    cv::Point2f back2 = ObjectRender::vectorAddRelative(bed0, bed2, bed0, 0, 1.0 / 6);
-    cv::Point2f back4 = ObjectRender::vectorAddRelative(bed1, bed4, bed1, 0, 1.0 / 6);
-
-
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(bed0.x, -bed0.y);
-    glVertex2f(bed1.x, -bed1.y);
-    glVertex2f(back6.x, -back6.y);
-    glVertex2f(back3.x, -back3.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(bed0.x, -bed0.y);
-    glVertex2f(back3.x, -back3.y);
-    glVertex2f(back7.x, -back7.y);
-    glVertex2f(back2.x, -back2.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(bed1.x, -bed1.y);
-    glVertex2f(back6.x, -back6.y);
-    glVertex2f(back5.x, -back5.y);
-    glVertex2f(back4.x, -back4.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(back2.x, -back2.y);
-    glVertex2f(back7.x, -back7.y);
-    glVertex2f(back5.x, -back5.y);
-    glVertex2f(back4.x, -back4.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(back3.x, -back3.y);
-    glVertex2f(back6.x, -back6.y);
-    glVertex2f(back5.x, -back5.y);
-    glVertex2f(back7.x, -back7.y);
-    glEnd();
-    
+)";
+
+// BGR frames arrive in the right order through the texture swizzle, YUYV frames are one (Y, U or V) texel per pixel
+static const char* FRAME_FRAGMENT_SHADER = R"(
+#version 330 core
+uniform sampler2D frame;
+uniform bool yuyv;
+in vec2 texCoord;
+out vec4 fragColor;
+void main(){
+    if (!yuyv){
+        fragColor = vec4(texture(frame, texCoord).rgb, 1.0);
+        return;
+    }
+    ivec2 size = textureSize(frame, 0);
+    ivec2 p = min(ivec2(texCoord * vec2(size)), size - 1);
+    // BT.601 with the limited range of the camera, like cv::COLOR_YUV2RGB_YUYV
+    float y = 1.164 * (texelFetch(frame, p, 0).r - 0.0627);
+    float u = texelFetch(frame, ivec2(p.x & ~1, p.y), 0).g - 0.502;
+    float v = texelFetch(frame, ivec2(p.x | 1, p.y), 0).g - 0.502;
+    fragColor = vec4(y + 1.596 * v, y - 0.391 * u - 0.813 * v, y + 2.018 * u, 1.0);
 }
-
-
-
-void ObjectRender::drawSmallSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)2/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[2], projectedGLPoints[1], 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[0], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[2], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float)2/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[0], projectedGLPoints[4], 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[0], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[2], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[5], leg44, 0, (float)2/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)2/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    
-    
-    // sofa seat
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glEnd();
-    //5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glEnd();
-    //top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
-    
-    // upper part of the sofa to lean on
-    cv::Point2f new3 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, 1.75);
-    cv::Point2f new6 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, 1.75);
-    cv::Point2f new5_bottom = ObjectRender::vectorAddRelative(leg14, projectedGLPoints[6], leg11, 1, 1);
-    cv::Point2f new7_bottom = ObjectRender::vectorAddRelative(leg02, projectedGLPoints[3], leg00, 1, 1);
-    cv::Point2f new5_top = ObjectRender::vectorAddRelative(leg14, new5_bottom, leg14, 0, 1.75);
-    cv::Point2f new7_top = ObjectRender::vectorAddRelative(leg02, new7_bottom, leg02, 0, 1.75);
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    
-    // 3737
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-   
-    // 5656
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    
-    // 5757
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-    
-    //top
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glEnd();
-    
-    
-    // sofa side handles
-    
-    // for inner part
-    cv::Point2f left_bottom = ObjectRender::vectorAddRelative(leg25, projectedGLPoints[7], leg27, 1, 1);
-    cv::Point2f left_top = ObjectRender::vectorAddRelative(left_bottom, new7_top, projectedGLPoints[7], 1, 1);
-    cv::Point2f left_inner = ObjectRender::vectorAddRelative(left_top, new7_bottom, new7_top, 1, 1);
-    cv::Point2f right_bottom = ObjectRender::vectorAddRelative(leg47, projectedGLPoints[5], leg45, 1, 1);
-    cv::Point2f right_top = ObjectRender::vectorAddRelative(right_bottom, new5_top, projectedGLPoints[5], 1, 1);
-    cv::Point2f right_inner = ObjectRender::vectorAddRelative(right_top, new5_bottom, new5_top, 1, 1);
-    
-    //drawing handles
-    glBegin(GL_TRIANGLES);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(left_top.x, -left_top.y);
-    glVertex2f(left_inner.x, -left_inner.y);
-    glVertex2f(left_bottom.x, -left_bottom.y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(right_top.x, -right_top.y);
-    glVertex2f(right_inner.x, -right_inner.y);
-    glVertex2f(right_bottom.x, -right_bottom.y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    
-    glEnd();
-    
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(left_top.x, -left_top.y);
-    glVertex2f(left_bottom.x, -left_bottom.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(right_bottom.x, -right_bottom.y);
-    glVertex2f(right_top.x, -right_top.y);
-    
-    glEnd();
-
+)";
+
+// compiles one shader stage, 0 if it fails
+static GLuint compileShader(GLenum type, const char* source){
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, NULL);
+    glCompileShader(shader);
+    GLint compiled;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled){
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        cout << "[GLFW] Failed to compile shader: " << log << endl;
+        glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
 }
 
-void ObjectRender::drawLongSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-    // extending some points to lengthen the sofa
-    cv::Point2f extend6 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[6], projectedGLPoints[3], 0, 2);
-    cv::Point2f extend5 = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectedGLPoints[5], projectedGLPoints[7], 0, 2);
-    cv::Point2f extend1 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 2);
-    cv::Point2f extend4 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, 2);
-    
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)2/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(extend1, projectedGLPoints[2], extend1, 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[1], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, extend4, leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, extend6, leg11, 0, (float)2/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(extend4, projectedGLPoints[0], extend4, 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, extend1, leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[4], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, extend5, leg44, 0, (float)2/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)2/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-
-    
-    // sofa seat
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glEnd();
-    // 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(extend5.x, -extend5.y);
-    glEnd();
-    // top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-     
-    
-    //upper parts of the sofa to lean on
-    cv::Point2f new3 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, 1.75);
-    cv::Point2f new6_top = ObjectRender::vectorAddRelative(new3, extend6, projectedGLPoints[3], 1, 1);
-    cv::Point2f new6_bottom = ObjectRender::vectorAddRelative(projectedGLPoints[3], new6_top, new3, 1, 1);
-    
-    cv::Point2f new7_bottom = ObjectRender::vectorAddRelative(leg02, projectedGLPoints[3], leg00, 1, 1);
-    cv::Point2f new7_top = ObjectRender::vectorAddRelative(leg02, new7_bottom, leg02, 0, 1.75);
-    
-    cv::Point2f new5_top = ObjectRender::vectorAddRelative(new7_top, new6_top, new3, 1, 1);
-    cv::Point2f new5_bottom = ObjectRender::vectorAddRelative(new5_top, new6_bottom, new6_top, 1, 1);
-    
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6_top.x, -new6_top.y);
-    glVertex2f(new6_bottom.x, -new6_bottom.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    
-    // 3737
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-   
-    // 5656
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new6_top.x, -new6_top.y);
-    glVertex2f(new6_bottom.x, -new6_bottom.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-     
-    // 5757
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-     
-    // top
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6_top.x, -new6_top.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new7_top.x, -new7_top.y);
-    
-    glEnd();
-    
-    // sofa side handles
-    // for inner handle
-    cv::Point2f left_bottom = ObjectRender::vectorAddRelative(leg25, projectedGLPoints[7], leg27, 1, 1);
-    cv::Point2f left_top = ObjectRender::vectorAddRelative(left_bottom, new7_top, projectedGLPoints[7], 1, 1);
-    cv::Point2f left_inner = ObjectRender::vectorAddRelative(left_top, new7_bottom, new7_top, 1, 1);
-    
-    cv::Point2f right_bottom = ObjectRender::vectorAddRelative(leg47, extend5, leg45, 1, 1);
-    cv::Point2f right_top = ObjectRender::vectorAddRelative(right_bottom, new5_top, extend5, 1, 1);
-    cv::Point2f right_inner = ObjectRender::vectorAddRelative(right_top, new5_bottom, new5_top, 1, 1);
-   
-    // drawing handles
-    glBegin(GL_TRIANGLES);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(left_top.x, -left_top.y);
-    glVertex2f(left_inner.x, -left_inner.y);
-    glVertex2f(left_bottom.x, -left_bottom.y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(right_top.x, -right_top.y);
-    glVertex2f(right_inner.x, -right_inner.y);
-    glVertex2f(right_bottom.x, -right_bottom.y);
-    
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(extend5.x, -extend5.y);
-    
-    glEnd();
-   
-    glBegin(GL_QUADS);
-    
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(left_top.x, -left_top.y);
-    glVertex2f(left_bottom.x, -left_bottom.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(right_bottom.x, -right_bottom.y);
-    glVertex2f(right_top.x, -right_top.y);
-    
-    glEnd();
-
+// links the two stages, the shaders give their attributes fixed locations themselves, 0 if it fails
+static GLuint linkProgram(const char* name, const char* vertexSource, const char* fragmentSource){
+    GLuint vertexShader = compileShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    if (!vertexShader || !fragmentShader){
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vertexShader);
+    glAttachShader(program, fragmentShader);
+    glLinkProgram(program);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+    GLint linked;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked){
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        cout << "[GLFW] Failed to link the " << name << " shader: " << log << endl;
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
 }
 
-
-void ObjectRender::drawTableForSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    // extending some points to lengthen the table
-    cv::Point2f extend6 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[6], projectedGLPoints[3], 0, 2);
-    cv::Point2f extend5 = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectedGLPoints[5], projectedGLPoints[7], 0, 2);
-    cv::Point2f extend1 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 2);
-    cv::Point2f extend4 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, 2);
-    
-    // preparing some points to draw the leg
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)4/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(extend1, projectedGLPoints[2], extend1, 0, 0);
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, extend6, leg11, 0, (float)4/6);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(extend4, projectedGLPoints[0], extend4, 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, extend5, leg44, 0, (float)4/6);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)4/6);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    
-    // drawing leg
-    glBegin(GL_QUADS);
-
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
- 
-    glEnd();
-    
-    // table top
-    // table board 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // table board 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // table board 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(extend6.x, -extend6.y);
-    glEnd();
-    // table board 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(extend5.x, -extend5.y);
-    glEnd();
-    // table board top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(extend6.x, -extend6.y);
-    glVertex2f(extend5.x, -extend5.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
+// a vertex array reading MeshVertex from the buffer
+static void createVertexArray(GLuint& vertexArray, GLuint& buffer){
+    glGenVertexArrays(1, &vertexArray);
+    glBindVertexArray(vertexArray);
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const void*)offsetof(MeshVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (const void*)offsetof(MeshVertex, color));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
 }
 
-
-void ObjectRender::drawDiningTable(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    // extending some points to lengthen the table
-    cv::Point2f extend6 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[6], projectedGLPoints[3], 0, 2);
-    cv::Point2f extend5 = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectedGLPoints[5], projectedGLPoints[7], 0, 2);
-    cv::Point2f extend1 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 2);
-    cv::Point2f extend4 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, 2);
-    
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)4/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(extend1, projectedGLPoints[2], extend1, 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[1], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, extend4, leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, extend6, leg11, 0, (float)4/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(extend4, projectedGLPoints[0], extend4, 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, extend1, leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[4], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, extend5, leg44, 0, (float)4/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)4/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    
-    
-    // some new coordinates for table top
-    cv::Point2f stretch3 = ObjectRender::vectorAddRelative(extend5, projectedGLPoints[3], extend5, 0, 1.25);
-    cv::Point2f stretch6 = ObjectRender::vectorAddRelative(projectedGLPoints[7], extend6, projectedGLPoints[7], 0, 1.25);
-    cv::Point2f stretch5 = ObjectRender::vectorAddRelative(projectedGLPoints[3], extend5, projectedGLPoints[3], 0, 1.25);
-    cv::Point2f stretch7 = ObjectRender::vectorAddRelative(extend6, projectedGLPoints[7], extend6, 0, 1.25);
-    
-    // table top
-    // table board 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(stretch6.x, -stretch6.y);
-    glVertex2f(stretch3.x, -stretch3.y);
-    glEnd();
-    // table board 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(stretch3.x, -stretch3.y);
-    glVertex2f(stretch7.x, -stretch7.y);
-    glEnd();
-    // table board 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(stretch5.x, -stretch5.y);
-    glVertex2f(stretch6.x, -stretch6.y);
-    glEnd();
-    // table board 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(stretch7.x, -stretch7.y);
-    glVertex2f(stretch5.x, -stretch5.y);
-    glEnd();
-    // table board top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(stretch3.x, -stretch3.y);
-    glVertex2f(stretch6.x, -stretch6.y);
-    glVertex2f(stretch5.x, -stretch5.y);
-    glVertex2f(stretch7.x, -stretch7.y);
-    glEnd();
-
+// points the per instance attributes of the bound vertex array at the instances from offset on
+static void instanceAttributes(GLuint instanceBuffer, size_t offset){
+    glBindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+    // a mat4 attribute takes one location per column
+    for (int c = 0; c < 4; c++){
+        glVertexAttribPointer(2 + c, 4, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (const void*)(offset + offsetof(MeshInstance, modelView) + c * 4 * sizeof(GLfloat)));
+    }
+    glVertexAttribPointer(6, 3, GL_FLOAT, GL_FALSE, sizeof(MeshInstance), (const void*)(offset + offsetof(MeshInstance, tint)));
 }
 
-void ObjectRender::drawDiningChair(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale){
-    
-    // leg0
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1-scale)/2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1-scale)/2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1-scale)/2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1-scale)/2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1-scale)/2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1-scale)/2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1-scale)/2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1-scale)/2);
-
-
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[4], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale/6));
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[4], leg00, 0, (float)(scale/6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[2], leg00, 0, (float)(scale/6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float)3/6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-    
-    // leg0
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    // leg1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[2], projectedGLPoints[1], 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[0], leg11, 0, (float)(scale/6));
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[2], leg11, 0, (float)(scale/6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[4], leg11, 0, (float)(scale/6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float)3/6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(leg16, leg14, leg11, 1, 1);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg16, leg12, leg11, 1, 1);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg10, leg11, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    // leg4
-    cv::Point2f leg44 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[0], projectedGLPoints[4], 0, 0);
-    cv::Point2f leg40 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[0], leg44, 0, (float)(scale/6));
-    cv::Point2f leg41 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[1], leg44, 0, (float)(scale/6));
-    cv::Point2f leg42 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[2], leg44, 0, (float)(scale/6));
-    cv::Point2f leg45 = ObjectRender::vectorAddRelative(leg44, projectedGLPoints[5], leg44, 0, (float)3/6);
-    cv::Point2f leg46 = ObjectRender::vectorAddRelative(leg45, leg41, leg44, 1, 1);
-    cv::Point2f leg47 = ObjectRender::vectorAddRelative(leg45, leg42, leg44, 1, 1);
-    cv::Point2f leg43 = ObjectRender::vectorAddRelative(leg45, leg40, leg44, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg43.x, -leg43.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg40.x, -leg40.y);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg47.x, -leg47.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg41.x, -leg41.y);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg46.x, -leg46.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg44.x, -leg44.y);
-    glVertex2f(leg42.x, -leg42.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glVertex2f(leg45.x, -leg45.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg43.x, -leg43.y);
-    glVertex2f(leg46.x, -leg46.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg47.x, -leg47.y);
-    glEnd();
-    // leg2
-    cv::Point2f leg22 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[1], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg20 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[0], leg22, 0, (float)(scale/6));
-    cv::Point2f leg21 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[1], leg22, 0, (float)(scale/6));
-    cv::Point2f leg24 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[4], leg22, 0, (float)(scale/6));
-    cv::Point2f leg27 = ObjectRender::vectorAddRelative(leg22, projectedGLPoints[7], leg22, 0, (float)3/6);
-    cv::Point2f leg23 = ObjectRender::vectorAddRelative(leg27, leg20, leg22, 1, 1);
-    cv::Point2f leg25 = ObjectRender::vectorAddRelative(leg27, leg24, leg22, 1, 1);
-    cv::Point2f leg26 = ObjectRender::vectorAddRelative(leg27, leg21, leg22, 1, 1);
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg23.x, -leg23.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg20.x, -leg20.y);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg27.x, -leg27.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg21.x, -leg21.y);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg26.x, -leg26.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg24.x, -leg24.y);
-    glVertex2f(leg22.x, -leg22.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg25.x, -leg25.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg23.x, -leg23.y);
-    glVertex2f(leg26.x, -leg26.y);
-    glVertex2f(leg25.x, -leg25.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glEnd();
-    
-    
-    // seat
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glEnd();
-    // 3737
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-    // 5656
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glEnd();
-    // 5757
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg45.x, -leg45.y);
-    glVertex2f(leg27.x, -leg27.y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glEnd();
-    // top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[5].x, -projectedGLPoints[5].y);
-    glVertex2f(projectedGLPoints[7].x, -projectedGLPoints[7].y);
-    glEnd();
-
-    
-    // upper part of the chair to lean on
-    cv::Point2f new3 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, 2);
-    cv::Point2f new6 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, 2);
-    cv::Point2f new5_bottom = ObjectRender::vectorAddRelative(leg14, projectedGLPoints[6], leg11, 1, 1);
-    cv::Point2f new7_bottom = ObjectRender::vectorAddRelative(leg02, projectedGLPoints[3], leg00, 1, 1);
-    cv::Point2f new5_top = ObjectRender::vectorAddRelative(leg14, new5_bottom, leg14, 0, 2);
-    cv::Point2f new7_top = ObjectRender::vectorAddRelative(leg02, new7_bottom, leg02, 0, 2);
-    // 3636
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    
-    // 3737
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(projectedGLPoints[3].x, -projectedGLPoints[3].y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-   
-    // 5656
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(projectedGLPoints[6].x, -projectedGLPoints[6].y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    
-    // 5757
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new5_bottom.x, -new5_bottom.y);
-    glVertex2f(new7_bottom.x, -new7_bottom.y);
-    
-    // top
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(new3.x, -new3.y);
-    glVertex2f(new6.x, -new6.y);
-    glVertex2f(new5_top.x, -new5_top.y);
-    glVertex2f(new7_top.x, -new7_top.y);
-    glEnd();
-    
+// [R | t] of a marker pose, from marker space to the camera space of OpenCV (x right, y down, z forward)
+static cv::Matx44f modelView(const cv::Vec3d& rvec, const cv::Vec3d& tvec){
+    cv::Matx33d R;
+    cv::Rodrigues(rvec, R);
+    cv::Matx44f M;
+    for (int r = 0; r < 3; r++){
+        for (int c = 0; c < 3; c++){
+            M(r, c) = R(r, c);
+        }
+        M(r, 3) = tvec[r];
+        M(3, r) = 0;
+    }
+    M(3, 3) = 1;
+    return M;
 }
 
-void ObjectRender::drawTV(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale) {
-
-    // adapt the scale
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1 - scale) / 2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1 - scale) / 2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1 - scale) / 2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1 - scale) / 2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1 - scale) / 2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1 - scale) / 2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1 - scale) / 2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1 - scale) / 2);
-    
-    scale = 1.0;
-    // helper extensions
-    cv::Point2f low3 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, scale * 5/ 6);      // height for the lower holder
-    cv::Point2f low6 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[6], projectedGLPoints[1], 0, scale * 5 / 6);
-    cv::Point2f high3 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, scale * 6 / 6);    // height for the higher holder
-    cv::Point2f high6 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[6], projectedGLPoints[1], 0, scale * 6 / 6);
-
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(low3, low6, low3, 0, scale * 3 / 6);
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(low3, low6, low3, 0, scale * 4 / 6);
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(low3, low6, low3, 0, scale * 8 / 6);
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(low3, low6, low3, 0, scale * 9 / 6);
-
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(high3, high6, high3, 0, scale * 3 / 6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(high3, high6, high3, 0, scale * 4 / 6);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(high3, high6, high3, 0, scale * 8 / 6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(high3, high6, high3, 0, scale * 9 / 6);
-
-    cv::Point2f low7 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[7], projectedGLPoints[2], 0, scale * 5 / 6);     // height for the lower holder
-    cv::Point2f low5 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[5], projectedGLPoints[4], 0, scale * 5 / 6);
-    cv::Point2f high7 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[7], projectedGLPoints[2], 0, scale * 6 / 6);    // height for the higher holder
-    cv::Point2f high5 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[5], projectedGLPoints[4], 0, scale * 6 / 6);
-
-    cv::Point2f low3b = ObjectRender::vectorAddRelative(low7, low3, low7, 0, scale * 7.0 / 6.0);
-    cv::Point2f low6b = ObjectRender::vectorAddRelative(low5, low6, low5, 0, scale * 7.0 / 6.0);
-    cv::Point2f high3b = ObjectRender::vectorAddRelative(high7, high3, high7, 0,  scale * 7.0 / 6.0);
-    cv::Point2f high6b = ObjectRender::vectorAddRelative(high5, high6, high5, 0, scale * 7.0 / 6.0);
-
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(low3b, low6b, low3b, 0, scale * 3 / 6);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(low3b, low6b, low3b, 0, scale * 4 / 6);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(low3b, low6b, low3b, 0, scale * 8 / 6);
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(low3b, low6b, low3b, 0, scale * 9 / 6);
-
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(high3b, high6b, high3b, 0, scale * 3 / 6);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(high3b, high6b, high3b, 0, scale * 4 / 6);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(high3b, high6b, high3b, 0, scale * 8 / 6);
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(high3b, high6b, high3b, 0, scale * 9 / 6);
-   
-
-    // leg 0
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    //
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    //
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-
-    // leg 1
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    //
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-
-
-    cv::Point2f corner1 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, scale * 12 / 6);
-    cv::Point2f corner4 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, scale * 12 / 6);
-    cv::Point2f corner6 = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectedGLPoints[6], projectedGLPoints[3], 0, scale * 12 / 6);
-    cv::Point2f corner5 = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectedGLPoints[5], projectedGLPoints[7], 0, scale * 12 / 6);
-
-    cv::Point2f tv0 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, scale * 4.0 / 6);     // low height tv
-    cv::Point2f tv3 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, scale * 8.0 / 6);     // high height tv
-    cv::Point2f tv1 = ObjectRender::vectorAddRelative(corner1, corner6, corner1, 0, scale * 4.0 / 6);
-    cv::Point2f tv6 = ObjectRender::vectorAddRelative(corner1, corner6, corner1, 0, scale * 8.0 / 6);
-
-    cv::Point2f tvlow2 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[7], projectedGLPoints[2], 0, scale * 4.0 / 6);
-    cv::Point2f tvlow4 = ObjectRender::vectorAddRelative(corner4, corner5, corner4, 0, scale * 4.0 / 6);
-
-    cv::Point2f tv2 = ObjectRender::vectorAddRelative(tv0, tvlow2, tv0, 0, scale * 1 / 6);
-    cv::Point2f tv4 = ObjectRender::vectorAddRelative(tv1, tvlow4, tv1, 0, scale * 1 / 6);
-    cv::Point2f tv7 = ObjectRender::vectorAddRelative(tv3, projectedGLPoints[7], tv3, 0, scale * 1 / 6);
-    cv::Point2f tv5 = ObjectRender::vectorAddRelative(tv6, corner5, tv6, 0, scale * 1 / 6);
-
-    cv::Point2f screen7 = ObjectRender::vectorAddRelative(tv7, tv4, tv7, 0, scale * 0.5 / 6);
-    cv::Point2f screen5 = ObjectRender::vectorAddRelative(tv5, tv2, tv5, 0, scale * 0.5 / 6);
-    cv::Point2f screen4 = ObjectRender::vectorAddRelative(tv4, tv7, tv4, 0, scale * 0.5 / 6);
-    cv::Point2f screen2 = ObjectRender::vectorAddRelative(tv2, tv5, tv2, 0, scale * 0.5 / 6);
-    
-    
-    // tv
-    glBegin(GL_QUADS);
-    // 0142
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(tv0.x, -tv0.y);
-    glVertex2f(tv1.x, -tv1.y);
-    glVertex2f(tv4.x, -tv4.y);
-    glVertex2f(tv2.x, -tv2.y);
-    // 0163
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(tv0.x, -tv0.y);
-    glVertex2f(tv1.x, -tv1.y);
-    glVertex2f(tv6.x, -tv6.y);
-    glVertex2f(tv3.x, -tv3.y);
-    // 2037
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(tv2.x, -tv2.y);
-    glVertex2f(tv0.x, -tv0.y);
-    glVertex2f(tv3.x, -tv3.y);
-    glVertex2f(tv7.x, -tv7.y);
-    // 1456
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(tv1.x, -tv1.y);
-    glVertex2f(tv4.x, -tv4.y);
-    glVertex2f(tv5.x, -tv5.y);
-    glVertex2f(tv6.x, -tv6.y);
-    // 2457
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(tv2.x, -tv2.y);
-    glVertex2f(tv4.x, -tv4.y);
-    glVertex2f(tv5.x, -tv5.y);
-    glVertex2f(tv7.x, -tv7.y);
-    // 3657
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(tv3.x, -tv3.y);
-    glVertex2f(tv6.x, -tv6.y);
-    glVertex2f(tv5.x, -tv5.y);
-    glVertex2f(tv7.x, -tv7.y);
-    glEnd();
-    
-    //black screen
-    glBegin(GL_QUADS);
-    glColor3f(0.1, 0.1, 0.1);
-    glVertex2f(screen7.x, -screen7.y);
-    glVertex2f(screen5.x, -screen5.y);
-    glVertex2f(screen4.x, -screen4.y);
-    glVertex2f(screen2.x, -screen2.y);
-    glEnd();
-    
+cv::Matx44f ObjectRender::cameraProjection(const cv::Mat& cameraMatrix, int frame_width, int frame_height){
+    cv::Matx33d K;
+    for (int i = 0; i < 9; i++){
+        K(i / 3, i % 3) = cameraMatrix.depth() == CV_32F ? cameraMatrix.at<float>(i / 3, i % 3) : cameraMatrix.at<double>(i / 3, i % 3);
+    }
+    // the pixel coordinates of K scaled to [-1, 1], with y flipped, and z mapped from [near, far] to [-1, 1]
+    cv::Matx44f P;
+    P(0, 0) = 2 * K(0, 0) / frame_width;
+    P(0, 1) = 2 * K(0, 1) / frame_width;
+    P(0, 2) = 2 * K(0, 2) / frame_width - 1;
+    P(1, 1) = -2 * K(1, 1) / frame_height;
+    P(1, 2) = 1 - 2 * K(1, 2) / frame_height;
+    P(2, 2) = (FAR_PLANE + NEAR_PLANE) / (FAR_PLANE - NEAR_PLANE);
+    P(2, 3) = -2 * FAR_PLANE * NEAR_PLANE / (FAR_PLANE - NEAR_PLANE);
+    P(3, 2) = 1;
+    return P;
 }
 
-void ObjectRender::drawCarpet(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale) {
-    
-    // scalability
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1 - scale) / 2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1 - scale) / 2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1 - scale) / 2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1 - scale) / 2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1 - scale) / 2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1 - scale) / 2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1 - scale) / 2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1 - scale) / 2);
-
-    scale = 1.0;
-    // vertices 0
-    cv::Point2f leg00 = projectedGLPoints[1];
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[4], projectedGLPoints[2], 0, 2);
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[4], projectedGLPoints[1], 0, 2);
-    cv::Point2f leg06 = projectedGLPoints[2];
-
-    //extensions 0
-    cv::Point2f corner07 = projectedGLPoints[0];
-    cv::Point2f corner01 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[1], projectedGLPoints[0], 0, 2);
-    cv::Point2f corner05 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[2], projectedGLPoints[0], 0, 2);
-    cv::Point2f corner03 = ObjectRender::vectorAddRelative(corner01, leg02, corner01, 0, 2);
-
-    // vertices 0
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(corner01, corner05, corner01, 0, scale * 1 / 6);
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(corner03, corner07, corner03, 0, scale * 1 / 6);
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(corner05, corner01, corner05, 0, scale * 1 / 6);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(corner07, corner03, corner07, 0, scale * 1 / 6);
-    
-    // high extensions 1
-    cv::Point2f ext0 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, scale * 0.5 / 6);
-    cv::Point2f ext1 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[6], projectedGLPoints[1], 0, scale * 0.5 / 6);
-    cv::Point2f ext2 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[7], projectedGLPoints[2], 0, scale * 0.5 / 6);
-    cv::Point2f ext4 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[5], projectedGLPoints[4], 0, scale * 0.5 / 6);
-
-    // vertices 1
-    cv::Point2f leg10 = ext1;
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(ext2, ext4, ext2, 0, 2);
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(ext1, ext4, ext1, 0, 2);
-    cv::Point2f leg16 = ext2;
-
-    //extensions 1
-    cv::Point2f corner17 = ext0;
-    cv::Point2f corner11 = ObjectRender::vectorAddRelative(ext0, ext1, ext0, 0, 2);
-    cv::Point2f corner15 = ObjectRender::vectorAddRelative(ext0, ext2, ext0, 0, 2);
-    cv::Point2f corner13 = ObjectRender::vectorAddRelative(corner11, leg12, corner11, 0, 2);
+bool ObjectRender::initScene(const FurnitureMeshes& furniture, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, int frame_width, int frame_height, SceneBuffers& buffers){
+    // all furniture models share one vertex buffer, a type without a model is simply never drawn
+    for (int type = 0; type < 12; type++){
+        buffers.meshFirst[type] = 0;
+        buffers.meshCount[type] = 0;
+        for (const FurnitureModel& model : furniture.models){
+            if (model.name == FURNITURE_NAMES[type]){
+                buffers.meshFirst[type] = model.first;
+                buffers.meshCount[type] = model.count;
+            }
+        }
+        if (buffers.meshCount[type] == 0){
+            cout << "[prog] no furniture model named " << FURNITURE_NAMES[type] << ", its markers are not drawn" << endl;
+        }
+    }
 
-    // vertices 1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(corner11, corner15, corner11, 0, scale * 1 / 6);
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(corner13, corner17, corner13, 0, scale * 1 / 6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(corner15, corner11, corner15, 0, scale * 1 / 6);
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(corner17, corner13, corner17, 0, scale * 1 / 6);
+    buffers.meshProgram = linkProgram("mesh", MESH_VERTEX_SHADER, MESH_FRAGMENT_SHADER);
+    buffers.frameProgram = linkProgram("camera frame", FRAME_VERTEX_SHADER, FRAME_FRAGMENT_SHADER);
+    if (!buffers.meshProgram || !buffers.frameProgram){
+        return false;
+    }
 
-    // carpet
-    glBegin(GL_POLYGON);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glEnd();
-    //
-    
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[0][0], orangeSalmon[0][1], orangeSalmon[0][2]);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[1][0], orangeSalmon[1][1], orangeSalmon[1][2]);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glEnd();
-    //
-    glBegin(GL_POLYGON);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glEnd();
-    
+    // the camera never changes, its projection and distortion are uploaded once
+    cv::Matx44f projection = cameraProjection(cameraMatrix, frame_width, frame_height);
+    cv::Mat coeffs;
+    distCoeffs.convertTo(coeffs, CV_64F);
+    GLfloat k[8] = {};      // k1 k2 p1 p2 k3 k4 k5 k6, missing ones are 0
+    for (int i = 0; i < 8 && i < (int)coeffs.total(); i++){
+        k[i] = coeffs.at<double>(i);
+    }
+    glUseProgram(buffers.meshProgram);
+    glUniformMatrix4fv(glGetUniformLocation(buffers.meshProgram, "projection"), 1, GL_TRUE, projection.val);
+    glUniform3f(glGetUniformLocation(buffers.meshProgram, "radial"), k[0], k[1], k[4]);
+    glUniform3f(glGetUniformLocation(buffers.meshProgram, "rational"), k[5], k[6], k[7]);
+    glUniform2f(glGetUniformLocation(buffers.meshProgram, "tangential"), k[2], k[3]);
+    glUseProgram(0);
+
+    createVertexArray(buffers.meshArray, buffers.meshBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers.meshBuffer);
+    // straight from the cache mapping when the models were not just compiled
+    glBufferData(GL_ARRAY_BUFFER, furniture.vertexCount * sizeof(MeshVertex), furniture.vertices, GL_STATIC_DRAW);
+    // the furniture arrays step through the instances once per drawn mesh instead of once per vertex
+    glGenBuffers(1, &buffers.instanceBuffer);
+    glBindVertexArray(buffers.meshArray);
+    instanceAttributes(buffers.instanceBuffer, 0);
+    for (int location = 2; location <= 6; location++){
+        glEnableVertexAttribArray(location);
+        glVertexAttribDivisor(location, 1);
+    }
+    glBindVertexArray(0);
+    // the walls depend on four markers at once, they are rebuilt in camera space every frame
+    createVertexArray(buffers.wallArray, buffers.wallBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    // the camera frame triangle is made up in the vertex shader, its array reads nothing
+    glGenVertexArrays(1, &buffers.frameArray);
+
+    cout << "[GLFW] " << furniture.vertexCount / 3 << " furniture triangles uploaded" << endl;
+    return true;
 }
 
-void ObjectRender::drawBookshelf(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale) {
-    
-    // scalability
-    vector<cv::Point2f> projectClone = projectedGLPoints;
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[3], projectedGLPoints[0], 0, scale);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[6], projectedGLPoints[1], 0, scale);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[7], projectedGLPoints[2], 0, scale);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[5], projectedGLPoints[4], 0, scale);
-
-    projectedGLPoints[0] = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectClone[4], projectedGLPoints[0], 0, (1 - scale) / 2);
-    projectedGLPoints[1] = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectClone[2], projectedGLPoints[1], 0, (1 - scale) / 2);
-    projectedGLPoints[2] = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectClone[1], projectedGLPoints[2], 0, (1 - scale) / 2);
-    projectedGLPoints[3] = ObjectRender::vectorAddRelative(projectedGLPoints[3], projectClone[5], projectedGLPoints[3], 0, (1 - scale) / 2);
-    projectedGLPoints[4] = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectClone[0], projectedGLPoints[4], 0, (1 - scale) / 2);
-    projectedGLPoints[5] = ObjectRender::vectorAddRelative(projectedGLPoints[5], projectClone[3], projectedGLPoints[5], 0, (1 - scale) / 2);
-    projectedGLPoints[6] = ObjectRender::vectorAddRelative(projectedGLPoints[6], projectClone[7], projectedGLPoints[6], 0, (1 - scale) / 2);
-    projectedGLPoints[7] = ObjectRender::vectorAddRelative(projectedGLPoints[7], projectClone[6], projectedGLPoints[7], 0, (1 - scale) / 2);
-
-    scale = 1.0;
-    // wall 0
-    cv::Point2f leg00 = ObjectRender::vectorAddRelative(projectedGLPoints[0], projectedGLPoints[3], projectedGLPoints[0], 0, 0);
-    cv::Point2f leg01 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[1], leg00, 0, (float)(scale / 6));
-    cv::Point2f leg02 = ObjectRender::vectorAddRelative(projectedGLPoints[2], projectedGLPoints[7], projectedGLPoints[2], 0, 0);
-    cv::Point2f leg04 = ObjectRender::vectorAddRelative(leg02, projectedGLPoints[4], leg02, 0, (float)(scale / 6));
-    cv::Point2f leg03 = ObjectRender::vectorAddRelative(leg00, projectedGLPoints[3], leg00, 0, (float) 9 / 6);
-    
-    cv::Point2f leg05 = ObjectRender::vectorAddRelative(leg03, leg04, leg00, 1, 1);
-    cv::Point2f leg06 = ObjectRender::vectorAddRelative(leg03, leg01, leg00, 1, 1);
-    cv::Point2f leg07 = ObjectRender::vectorAddRelative(leg03, leg02, leg00, 1, 1);
-
-    cv::Point2f shelf01 = ObjectRender::vectorAddRelative(leg01, leg06, leg01, 0, (float)(scale / 6));
-    cv::Point2f shelf04 = ObjectRender::vectorAddRelative(leg04, leg05, leg04, 0, (float)(scale / 6));
-    cv::Point2f shelf11 = ObjectRender::vectorAddRelative(leg01, leg06, leg01, 0, (float)(scale * 3 / 6));
-    cv::Point2f shelf14 = ObjectRender::vectorAddRelative(leg04, leg05, leg04, 0, (float)(scale * 3 / 6));
-    cv::Point2f shelf21 = ObjectRender::vectorAddRelative(leg01, leg06, leg01, 0, (float)(scale * 3.5 / 6));
-    cv::Point2f shelf24 = ObjectRender::vectorAddRelative(leg04, leg05, leg04, 0, (float)(scale * 3.5 / 6));
-    cv::Point2f shelf31 = ObjectRender::vectorAddRelative(leg01, leg06, leg01, 0, (float)(scale * 5.5 / 6));
-    cv::Point2f shelf34 = ObjectRender::vectorAddRelative(leg04, leg05, leg04, 0, (float)(scale * 5.5 / 6));
-    cv::Point2f shelf41 = ObjectRender::vectorAddRelative(leg01, leg06, leg01, 0, (float)(scale * 6 / 6));
-    cv::Point2f shelf44 = ObjectRender::vectorAddRelative(leg04, leg05, leg04, 0, (float)(scale * 6 / 6));
-
-
-    // wall 1
-    cv::Point2f leg11 = ObjectRender::vectorAddRelative(projectedGLPoints[1], projectedGLPoints[6], projectedGLPoints[1], 0, 0);
-    cv::Point2f leg10 = ObjectRender::vectorAddRelative(leg11, leg01, leg11, 0, (float)(scale / 6));
-    cv::Point2f leg14 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[5], projectedGLPoints[4], 0, 0);
-    cv::Point2f leg12 = ObjectRender::vectorAddRelative(leg14, projectedGLPoints[2], leg14, 0, (float)(scale / 6));
-    cv::Point2f leg16 = ObjectRender::vectorAddRelative(leg11, projectedGLPoints[6], leg11, 0, (float)(scale*9 / 6));
-    cv::Point2f leg13 = ObjectRender::vectorAddRelative(leg16, leg06, leg16, 0, (float) scale / 6);
-    cv::Point2f leg15 = ObjectRender::vectorAddRelative(projectedGLPoints[4], projectedGLPoints[5], projectedGLPoints[4], 0, (float)(scale * 9/ 6));
-    cv::Point2f leg17 = ObjectRender::vectorAddRelative(leg15, leg07, leg15, 0, (float)(scale / 6));
-
-    cv::Point2f shelf00 = ObjectRender::vectorAddRelative(leg10, leg13, leg10, 0, (float)(scale / 6));
-    cv::Point2f shelf02 = ObjectRender::vectorAddRelative(leg12, leg17, leg12, 0, (float)(scale / 6));
-
-    cv::Point2f shelf10 = ObjectRender::vectorAddRelative(leg10, leg13, leg10, 0, (float)(scale * 3 / 6));
-    cv::Point2f shelf12 = ObjectRender::vectorAddRelative(leg12, leg17, leg12, 0, (float)(scale * 3 / 6));
-    cv::Point2f shelf20 = ObjectRender::vectorAddRelative(leg10, leg13, leg10, 0, (float)(scale * 3.5 / 6));
-    cv::Point2f shelf22 = ObjectRender::vectorAddRelative(leg12, leg17, leg12, 0, (float)(scale * 3.5 / 6));
-    cv::Point2f shelf30 = ObjectRender::vectorAddRelative(leg10, leg13, leg10, 0, (float)(scale * 5.5 / 6));
-    cv::Point2f shelf32 = ObjectRender::vectorAddRelative(leg12, leg17, leg12, 0, (float)(scale * 5.5 / 6));
-    cv::Point2f shelf40 = ObjectRender::vectorAddRelative(leg10, leg13, leg10, 0, (float)(scale * 6 / 6));
-    cv::Point2f shelf42 = ObjectRender::vectorAddRelative(leg12, leg17, leg12, 0, (float)(scale * 6 / 6));
+void ObjectRender::releaseScene(SceneBuffers& buffers){
+    glDeleteBuffers(1, &buffers.meshBuffer);
+    glDeleteBuffers(1, &buffers.wallBuffer);
+    glDeleteBuffers(1, &buffers.instanceBuffer);
+    glDeleteVertexArrays(1, &buffers.meshArray);
+    glDeleteVertexArrays(1, &buffers.wallArray);
+    glDeleteProgram(buffers.meshProgram);
+    glDeleteTextures(1, &buffers.frameTexture);
+    glDeleteBuffers(FRAME_PIXEL_BUFFERS, buffers.framePixelBuffers);
+    glDeleteVertexArrays(1, &buffers.frameArray);
+    glDeleteProgram(buffers.frameProgram);
+    buffers.meshBuffer = 0;
+    buffers.wallBuffer = 0;
+    buffers.instanceBuffer = 0;
+    buffers.meshArray = 0;
+    buffers.wallArray = 0;
+    buffers.meshProgram = 0;
+    buffers.frameTexture = 0;
+    fill(buffers.framePixelBuffers, buffers.framePixelBuffers + FRAME_PIXEL_BUFFERS, 0);
+    buffers.frameArray = 0;
+    buffers.frameProgram = 0;
+    buffers.frameSize = cv::Size();
+}
 
+// (re)allocates the frame texture and its pixel buffers for the size and format of the frame
+static void allocateFrameTexture(const cv::Mat& frame, SceneBuffers& buffers){
+    glDeleteTextures(1, &buffers.frameTexture);
+    glDeleteBuffers(FRAME_PIXEL_BUFFERS, buffers.framePixelBuffers);
+    bool yuyv = frame.channels() == 2;
+
+    glGenTextures(1, &buffers.frameTexture);
+    glBindTexture(GL_TEXTURE_2D, buffers.frameTexture);
+    // immutable storage needs OpenGL 4.2 or ARB_texture_storage, without it a single glTexImage2D level does the
+    // same since the texture is never mipmapped
+    if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage){
+        glTexStorage2D(GL_TEXTURE_2D, 1, yuyv ? GL_RG8 : GL_RGB8, frame.cols, frame.rows);
+    } else {
+        glTexImage2D(GL_TEXTURE_2D, 0, yuyv ? GL_RG8 : GL_RGB8, frame.cols, frame.rows, 0, yuyv ? GL_RG : GL_BGR, GL_UNSIGNED_BYTE, NULL);
+    }
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (!yuyv){
+        // the BGR bytes go in unchanged, sampling swaps red and blue
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, GL_BLUE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    // the rows of a BGR frame are not padded to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    glGenBuffers(FRAME_PIXEL_BUFFERS, buffers.framePixelBuffers);
+    for (int i = 0; i < FRAME_PIXEL_BUFFERS; i++){
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers.framePixelBuffers[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, frame.total() * frame.elemSize(), NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    glUseProgram(buffers.frameProgram);
+    glUniform1i(glGetUniformLocation(buffers.frameProgram, "yuyv"), yuyv);
+    glUseProgram(0);
+    buffers.frameSize = frame.size();
+    buffers.frameChannels = frame.channels();
+    buffers.nextPixelBuffer = 0;
+}
 
+void ObjectRender::drawCameraFrame(const cv::Mat& frame, SceneBuffers& buffers){
+    // the texture storage is allocated once, and again only if the frame size or format changes
+    if (!buffers.frameTexture || frame.size() != buffers.frameSize || frame.channels() != buffers.frameChannels){
+        allocateFrameTexture(frame, buffers);
+    }
 
+    // copy the frame into the next pixel buffer of the ring, while the ones before it may still be in transfer.
+    // Without pixel buffer memory the driver copies it out of the frame instead, either way it is one copy
+    FrameStats::countCopy(frame);
+    size_t rowBytes = frame.cols * frame.elemSize();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffers.framePixelBuffers[buffers.nextPixelBuffer]);
+    buffers.nextPixelBuffer = (buffers.nextPixelBuffer + 1) % FRAME_PIXEL_BUFFERS;
+    unsigned char* mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, rowBytes * frame.rows, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    const void* pixels = NULL;      // offset 0 of the pixel buffer
+    if (mapped){
+        if (frame.isContinuous()){
+            memcpy(mapped, frame.data, rowBytes * frame.rows);
+        } else {
+            for (int row = 0; row < frame.rows; row++){
+                memcpy(mapped + row * rowBytes, frame.ptr(row), rowBytes);
+            }
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+    } else {
+        // no pixel buffer memory, upload straight from the frame
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, frame.step / frame.elemSize());
+        pixels = frame.data;
+    }
 
-    // wall 0
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);;
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg03.x, -leg03.y);
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg00.x, -leg00.y);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg07.x, -leg07.y);
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg06.x, -leg06.y);
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(leg02.x, -leg02.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glVertex2f(leg05.x, -leg05.y);
-    //
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg03.x, -leg03.y);
-    glVertex2f(leg06.x, -leg06.y);
-    glVertex2f(leg05.x, -leg05.y);
-    glVertex2f(leg07.x, -leg07.y);
-    glEnd();
+    // returns right away when the pixels come from a pixel buffer, the copy into the texture happens on the GPU
+    glBindTexture(GL_TEXTURE_2D, buffers.frameTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, frame.cols, frame.rows, frame.channels() == 2 ? GL_RG : GL_RGB, GL_UNSIGNED_BYTE, pixels);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glUseProgram(buffers.frameProgram);
+    glBindVertexArray(buffers.frameArray);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glUseProgram(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-    
-    // shelf 0
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg04.x, -leg04.y);
-    glVertex2f(shelf04.x, -shelf04.y);
-    glVertex2f(shelf02.x, -shelf02.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(leg01.x, -leg01.y);
-    glVertex2f(shelf01.x, -shelf01.y);
-    glVertex2f(shelf00.x, -shelf00.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(shelf01.x, -shelf01.y);
-    glVertex2f(shelf00.x, -shelf00.y);
-    glVertex2f(shelf02.x, -shelf02.y);
-    glVertex2f(shelf04.x, -shelf04.y);
-    glEnd();
+void ObjectRender::drawScene(const MarkerDict& dict, const vector<MarkerResult>& markers, const vector<cv::Vec3d>& rvecs, const vector<cv::Vec3d>& tvecs, SceneBuffers& buffers){
+    // wall positions in the order of MarkerObject::type of the walls
+    static const char* const wallPositions[4] = {"topLeft", "topRight", "bottomRight", "bottomLeft"};
 
-    // shelf 1
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(shelf11.x, -shelf11.y);
-    glVertex2f(shelf10.x, -shelf10.y);
-    glVertex2f(shelf12.x, -shelf12.y);
-    glVertex2f(shelf14.x, -shelf14.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(shelf14.x, -shelf14.y);
-    glVertex2f(shelf24.x, -shelf24.y);
-    glVertex2f(shelf22.x, -shelf22.y);
-    glVertex2f(shelf12.x, -shelf12.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glVertex2f(shelf11.x, -shelf11.y);
-    glVertex2f(shelf21.x, -shelf21.y);
-    glVertex2f(shelf20.x, -shelf20.y);
-    glVertex2f(shelf10.x, -shelf10.y);
-    glEnd();
-    // shelf top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(shelf21.x, -shelf21.y);
-    glVertex2f(shelf20.x, -shelf20.y);
-    glVertex2f(shelf22.x, -shelf22.y);
-    glVertex2f(shelf24.x, -shelf24.y);
-    glEnd();
+    // beige: floor, left, right, ceiling
+    static const vector<vector<GLfloat>> wallColors{{0.851,0.725,0.608}, {1.,0.941,0.859}, {0.933,0.851,0.769}, {0.98,0.941,0.902}};
 
-    // shelf 2
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(shelf31.x, -shelf31.y);
-    glVertex2f(shelf30.x, -shelf30.y);
-    glVertex2f(shelf32.x, -shelf32.y);
-    glVertex2f(shelf34.x, -shelf34.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[3][0], orangeSalmon[3][1], orangeSalmon[3][2]);
-    glVertex2f(shelf34.x, -shelf34.y);
-    glVertex2f(shelf44.x, -shelf44.y);
-    glVertex2f(shelf42.x, -shelf42.y);
-    glVertex2f(shelf32.x, -shelf32.y);
-    glEnd();
-    //
-    glBegin(GL_QUADS);
-    glVertex2f(shelf31.x, -shelf31.y);
-    glVertex2f(shelf41.x, -shelf41.y);
-    glVertex2f(shelf40.x, -shelf40.y);
-    glVertex2f(shelf30.x, -shelf30.y);
-    glEnd();
-    // shelf top
-    glBegin(GL_QUADS);
-    glColor3f(orangeSalmon[2][0], orangeSalmon[2][1], orangeSalmon[2][2]);
-    glVertex2f(shelf41.x, -shelf41.y);
-    glVertex2f(shelf40.x, -shelf40.y);
-    glVertex2f(shelf42.x, -shelf42.y);
-    glVertex2f(shelf44.x, -shelf44.y);
-    glEnd();
-    
+    // count the furniture of each type first, so every type gets one contiguous run of instances
+    fill(buffers.instanceCount, buffers.instanceCount + 12, 0);
+    for (const MarkerResult& res : markers){
+        const MarkerObject& object = dict.objects[res.index];
+        if (object.objectClass == MARKER_FURNITURE){
+            buffers.instanceCount[object.type]++;
+        }
+    }
+    int total = 0;
+    for (int type = 0; type < 12; type++){
+        buffers.instanceFirst[type] = total;
+        total += buffers.instanceCount[type];
+    }
+    buffers.instances.resize(total);
+
+    int filled[12] = {};
+    buffers.wallMarkersSeen = 0;
+    for (int i = 0; i < markers.size(); i++){
+        const MarkerObject& object = dict.objects[markers[i].index];
+
+        if (object.objectClass == MARKER_WALL){
+            // store wall marker corners for easy access later, the first marker of each wall counts
+            int position = object.type;
+            if (!(buffers.wallMarkersSeen & (1 << position))){
+                buffers.wallMarkersSeen |= 1 << position;
+                cv::Matx44f M = modelView(rvecs[i], tvecs[i]);
+                vector<cv::Point3f>& corners = buffers.wallMarkerCorners[wallPositions[position]];
+                corners.resize(8);
+                for (int k = 0; k < 8; k++){
+                    const cv::Point3f& p = UNIT_CUBE[k];
+                    corners[k] = cv::Point3f(M(0, 0) * p.x + M(0, 1) * p.y + M(0, 2) * p.z + M(0, 3),
+                                             M(1, 0) * p.x + M(1, 1) * p.y + M(1, 2) * p.z + M(1, 3),
+                                             M(2, 0) * p.x + M(2, 1) * p.y + M(2, 2) * p.z + M(2, 3));
+                }
+            }
+        } else if (object.objectClass == MARKER_FURNITURE){
+            int type = object.type;
+            int n = filled[type]++;
+            MeshInstance& instance = buffers.instances[buffers.instanceFirst[type] + n];
+            cv::Matx44f M = modelView(rvecs[i], tvecs[i]);
+            for (int c = 0; c < 4; c++){
+                for (int r = 0; r < 4; r++){
+                    instance.modelView[c * 4 + r] = M(r, c);
+                }
+            }
+            copy(INSTANCE_TINTS[n % 4], INSTANCE_TINTS[n % 4] + 3, instance.tint);
+        }
+    }
 
-    // wall 1
-    glBegin(GL_QUADS);
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg13.x, -leg13.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg10.x, -leg10.y);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg17.x, -leg17.y);
-    //
-    glColor3f(babyBlue[0][0], babyBlue[0][1], babyBlue[0][2]);
-    glVertex2f(leg11.x, -leg11.y);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg16.x, -leg16.y);
-    //
-    glColor3f(babyBlue[1][0], babyBlue[1][1], babyBlue[1][2]);
-    glVertex2f(leg14.x, -leg14.y);
-    glVertex2f(leg12.x, -leg12.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glVertex2f(leg15.x, -leg15.y);
-    //
-    glColor3f(babyBlue[2][0], babyBlue[2][1], babyBlue[2][2]);
-    glVertex2f(leg13.x, -leg13.y);
-    glVertex2f(leg16.x, -leg16.y);
-    glVertex2f(leg15.x, -leg15.y);
-    glVertex2f(leg17.x, -leg17.y);
-    glEnd();
-    
+    glUseProgram(buffers.meshProgram);
+
+    // once all four markers are detected, draw the walls, in the order they were built and behind all furniture
+    if (buffers.wallMarkersSeen == 0xF) {
+        sortWallMarker(buffers.wallMarkerCorners, buffers.sortedWallName);
+        MeshBuilder& walls = buffers.wallMesh;
+        walls.vertices.clear();
+        walls.lines.clear();
+        buildWalls(buffers.wallMarkerCorners, buffers.sortedWallName, wallColors, true, true , 1.0f, walls);
+
+        size_t triangleBytes = walls.vertices.size() * sizeof(MeshVertex);
+        size_t lineBytes = walls.lines.size() * sizeof(MeshVertex);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.wallBuffer);
+        glBufferData(GL_ARRAY_BUFFER, triangleBytes + lineBytes, NULL, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, triangleBytes, walls.vertices.data());
+        glBufferSubData(GL_ARRAY_BUFFER, triangleBytes, lineBytes, walls.lines.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        // the wall array has no instance attributes, it reads these constants: already in camera space, untinted
+        glVertexAttrib4f(2, 1, 0, 0, 0);
+        glVertexAttrib4f(3, 0, 1, 0, 0);
+        glVertexAttrib4f(4, 0, 0, 1, 0);
+        glVertexAttrib4f(5, 0, 0, 0, 1);
+        glVertexAttrib3f(6, 1, 1, 1);
+        glBindVertexArray(buffers.wallArray);
+        glDrawArrays(GL_TRIANGLES, 0, walls.vertices.size());
+        glDrawArrays(GL_LINES, walls.vertices.size(), walls.lines.size());
+    }
 
-}
\ No newline at end of file
+    // draw detected objects on the markers, one instanced draw call per type, hiding each other where they overlap
+    if (total > 0){
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.instanceBuffer);
+        glBufferData(GL_ARRAY_BUFFER, total * sizeof(MeshInstance), buffers.instances.data(), GL_STREAM_DRAW);
+
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        glBindVertexArray(buffers.meshArray);
+        for (int type = 0; type < 12; type++){
+            if (buffers.instanceCount[type] == 0){
+                continue;
+            }
+            instanceAttributes(buffers.instanceBuffer, buffers.instanceFirst[type] * sizeof(MeshInstance));
+            glDrawArraysInstanced(GL_TRIANGLES, buffers.meshFirst[type], buffers.meshCount[type], buffers.instanceCount[type]);
+        }
+        glDisable(GL_DEPTH_TEST);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+    glBindVertexArray(0);
+    glUseProgram(0);
+}
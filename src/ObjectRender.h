@@ -1,9 +1,52 @@
+#pragma once
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 #include <opencv2/opencv.hpp>
+#include "MarkerDetection.h"
+#include "MeshBuilder.h"
+#include "FurnitureModels.h"
 
 using namespace std;
 
+/* One piece of furniture in the frame, in the layout of the instance buffer */
+struct MeshInstance{
+    GLfloat modelView[16];      // marker space to camera space, column-major like a GLSL mat4
+    GLfloat tint[3];            // multiplies the colors of the mesh
+};
+
+// pixel buffers the camera frames are uploaded through in turn, so writing one never waits for the transfer of the last
+const int FRAME_PIXEL_BUFFERS = 3;
+
+/* Buffers and GL objects that drawCameraFrame and drawScene reuse from one frame to the next, owned by the caller */
+struct SceneBuffers{
+    // the camera frame, uploaded as it is captured (BGR or YUYV) and converted while it is drawn
+    GLuint frameProgram = 0;
+    GLuint frameArray = 0;
+    GLuint frameTexture = 0;                                // immutable storage of the frame size
+    GLuint framePixelBuffers[FRAME_PIXEL_BUFFERS] = {};
+    int nextPixelBuffer = 0;
+    cv::Size frameSize;                                     // the size and channels the texture was allocated for
+    int frameChannels = 0;
+
+    map<string, vector<cv::Point3f>> wallMarkerCorners;     // camera space cube corners of the wall markers by their position
+    int wallMarkersSeen = 0;                                // bit mask of the wall positions detected in the current frame
+    vector<string> sortedWallName;
+    vector<MeshInstance> instances;                         // every furniture marker of the current frame, grouped by type
+    GLint instanceFirst[12] = {};                           // first instance of each furniture type
+    GLsizei instanceCount[12] = {};                         // instance count of each furniture type
+    MeshBuilder wallMesh;                                   // the walls of the current frame, in camera space
+
+    // the furniture meshes, built and uploaded once by initScene
+    GLuint meshProgram = 0;
+    GLuint meshArray = 0;
+    GLuint meshBuffer = 0;                                  // the meshes of all furniture types one after the other
+    GLint meshFirst[12] = {};                               // first vertex of each furniture type
+    GLsizei meshCount[12] = {};                             // vertex count of each furniture type
+    GLuint wallArray = 0;
+    GLuint wallBuffer = 0;                                  // wallMesh, triangles then lines, refilled every frame
+    GLuint instanceBuffer = 0;                              // instances, refilled every frame
+};
+
 class ObjectRender{
     public:
         /**
@@ -22,6 +65,20 @@ class ObjectRender{
         */
         static cv::Point2f vectorAddRelative(cv::Point2f a, cv::Point2f b, cv::Point2f origin, float scaleA, float scaleB);
 
+        /**
+         * Adds two vectors together relative to an origin point, in marker space where no axis is flipped
+         *
+         * The walls are built with this one once their corners are in camera space.
+         *
+         * @param a The first vector
+         * @param b The second vector
+         * @param origin The relative origin
+         * @param scaleA The scale of the first vector
+         * @param scaleB The scale of the second vector
+         * @return the sum of the two (scaled) vectors
+        */
+        static cv::Point3f vectorAddRelative(cv::Point3f a, cv::Point3f b, cv::Point3f origin, float scaleA, float scaleB);
+
         /**
          * Converts the projected points from OpenCV coordinate space to OpenGL coordinate space
          * 
@@ -31,79 +88,103 @@ class ObjectRender{
          * pointing up ([-1, 1] * [-1, 1]).
          * 
          * @param projectedPoints The 2D points in OpenCV coordinate space
+         * @param count The number of points
          * @param frame_width The width of the frame
          * @param frame_height The height of the frame
-         * @return vector of converted 2D projected points in OpenGL coordinate space
+         * @param points2D Receives the converted 2D projected points in OpenGL coordinate space
         */
-        static vector<cv::Point2f> convertToGLCoords(vector<cv::Point2f> projectedPoints, int frame_width, int frame_height);
+        static void convertToGLCoords(const cv::Point2f* projectedPoints, int count, int frame_width, int frame_height, vector<cv::Point2f>& points2D);
 
         /**
-         * Sorts the wall markers based on how close they are to the camera (higher y value = closer to camera), 
-         * since the OpenCV coordinate space has the y axis pointing down
+         * Sorts the wall markers based on how close they are to the camera, by the depth of their origin in
+         * camera space
          * 
-         * @param wallMarkers the map of wall markers
-         * @param frame_height the height of the frame
-         * @return vector of keys for the sorted wall markers map
+         * @param wallMarkers the map of wall markers, in camera space
+         * @param sortedMarkers Receives the keys for the sorted wall markers map
         */
-        static vector<string> sortWallMarker(map<string, vector<cv::Point2f>> wallMarkers, int frame_height);
+        static void sortWallMarker(const map<string, vector<cv::Point3f>>& wallMarkers, vector<string>& sortedMarkers);
 
         /**
-         * Draws a dynamic wall of the room based on the wall markers
+         * Builds a dynamic wall of the room based on the wall markers
          * 
-         * Only two walls are being drawn at a time. Depending on the camera's position, the closest two walls  
-         * to the camera are not drawn. This is to improve visibility of the room. 
+         * Only two walls are being built at a time. Depending on the camera's position, the closest two walls  
+         * to the camera are left out. This is to improve visibility of the room. 
          * 
-         * @param wallMarkerCorners The map of wall markers
+         * @param wallMarkerCorners The map of wall markers, the 8 cube corners of each in camera space
          * @param sortedKeyClosest The sorted keys of the wall markers
          * @param colors The colors of the walls
-         * @param outline Whether or not to draw the outline of the walls
-         * @param floor Whether or not to draw the floor
+         * @param outline Whether or not to build the outline of the walls
+         * @param floor Whether or not to build the floor
          * @param extraHeight The extra height of the walls
+         * @param mesh Receives the triangles, and the lines of the outline
         */
-        static void drawWalls(map<string, vector<cv::Point2f>> wallMarkerCorners, vector<string> sortedKeyClosest, vector<vector<GLfloat>> colors, bool outline, bool floor, float extraHeight);
+        static void buildWalls(const map<string, vector<cv::Point3f>>& wallMarkerCorners, const vector<string>& sortedKeyClosest, const vector<vector<GLfloat>>& colors, bool outline, bool floor, float extraHeight, MeshBuilder& mesh);
 
+        /**
+         * The OpenGL projection matrix of the calibrated camera
+         *
+         * Maps the camera space of the marker poses (x right, y down, z forward) to clip space so that a point
+         * lands on the same pixel as with cv::projectPoints without distortion, and gives it a depth.
+         *
+         * @param cameraMatrix The camera matrix
+         * @param frame_width The width of the frame
+         * @param frame_height The height of the frame
+         * @return the projection matrix
+        */
+        static cv::Matx44f cameraProjection(const cv::Mat& cameraMatrix, int frame_width, int frame_height);
+
+        /**
+         * Uploads the furniture meshes, with the shader that projects them
+         *
+         * Needs a current GL context with GLEW initialized. The models are picked by the furniture type of the
+         * markers, the meshes can be released once this returns. The shader distorts every vertex like
+         * cv::projectPoints, so the room lines up with a frame that still has the lens distortion; the edges
+         * between the vertices stay straight.
+         *
+         * @param furniture The compiled furniture models (FurnitureModels::loadOrCompile)
+         * @param cameraMatrix The camera matrix, its projection is set once here
+         * @param distCoeffs The distortion of the drawn frame (FramePipeline::projectionDistCoeffs), up to the
+         *                   8 coefficients of the rational model, empty or zero for an undistorted frame
+         * @param frame_width The width of the frame
+         * @param frame_height The height of the frame
+         * @param buffers Receives the GL objects
+         * @return false if the shader can't be compiled
+        */
+        static bool initScene(const FurnitureMeshes& furniture, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, int frame_width, int frame_height, SceneBuffers& buffers);
+
+        /**
+         * Deletes the GL objects of initScene
+         *
+         * @param buffers The buffers holding them
+        */
+        static void releaseScene(SceneBuffers& buffers);
+
+        /**
+         * Clears the screen and draws the frame as the background texture
+         * 
+         * The frame goes through a ring of pixel buffers into a texture allocated once. It is neither flipped
+         * nor color converted on the CPU: the shader reads it top row first, BGR through the texture swizzle
+         * and YUYV by converting it per pixel.
+         * 
+         * @param frame The BGR or YUYV camera frame
+         * @param buffers The buffers reused between frames
+        */
+        static void drawCameraFrame(const cv::Mat& frame, SceneBuffers& buffers);
 
-    // the following functions share the same parameters
         /**
-         * @param projectedGLPoints The GL projected points
-         * @param babyBlue The baby blue color
-         * @param orangeSalmon The orange salmon color
-         * @param scale The scale of the table
+         * Draws the walls and the furniture for all the markers detected in a frame
+         * 
+         * The walls are drawn once all four wall markers are visible, every other marker is drawn as the 
+         * furniture object its marker stands for. Any number of markers of the same type can be in the frame:
+         * their poses go into the instance buffer, and each furniture type is a single instanced draw call
+         * that moves its mesh into camera space by the pose of every marker and projects it by the camera. The
+         * depth test is on so the pieces hide each other where they overlap.
+         * 
+         * @param dict The marker dictionary, which tells the wall or furniture of each marker
+         * @param markers The detected markers
+         * @param rvecs The rotation vector of each marker
+         * @param tvecs The translation vector of each marker
+         * @param buffers The buffers reused between frames
         */
-    
-        /* Draws a 1x1 table based on the GL projected points */
-        static void drawTable1x1(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-    
-        /* Draws a 1x2 table based on the GL projected points */
-        static void drawTable1x2(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a basic chair (accompanying the table) based on the GL projected points*/
-        static void drawBasicChair(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-    
-        /* Draws a bed based on the GL projected points */
-        static void drawBed(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a small sofa based on the GL projected points */
-        static void drawSmallSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a long sofa based on the GL projected points */
-        static void drawLongSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a 1x1 table for the sofa based on the GL projected points */
-        static void drawTableForSofa(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a stylized dining table based on the GL projected points */
-        static void drawDiningTable(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a stylized dining chair based on the GL projected points */
-        static void drawDiningChair(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a TV object based on the projected GL points */        
-        static void drawTV(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-    
-        /* Draws a flat circular carpet on the marker based on the marker (GL) coordinates */
-        static void drawCarpet(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
-
-        /* Draws a bookshelf based on the GL projected points */
-        static void drawBookshelf(vector<cv::Point2f> projectedGLPoints, vector<vector<GLfloat>> babyBlue, vector<vector<GLfloat>> orangeSalmon, float scale);
+        static void drawScene(const MarkerDict& dict, const vector<MarkerResult>& markers, const vector<cv::Vec3d>& rvecs, const vector<cv::Vec3d>& tvecs, SceneBuffers& buffers);
 };
\ No newline at end of file
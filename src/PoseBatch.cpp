@@ -0,0 +1,214 @@
+#include "PoseBatch.h"
+
+#if defined(__SSE2__)
+#define POSEBATCH_SSE
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+// vdiv_f32 and vdup_laneq_f32 only exist on AArch64, 32-bit ARM takes the scalar path
+#define POSEBATCH_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace std;
+
+// the cube of MarkerDetection::projectCube, the marker lies in z = 0 and the cube rises towards the camera
+static const vector<cv::Point3f> CUBE {cv::Point3f{0, 0, 0}, cv::Point3f{1, 0, 0}, cv::Point3f{0, 1, 0}, cv::Point3f{0, 0, -1},
+    cv::Point3f{1, 1, 0}, cv::Point3f{1, 1, -1}, cv::Point3f{1, 0, -1}, cv::Point3f{0, 1, -1}};
+
+static double element(const cv::Mat& m, int r, int c){
+    return m.depth() == CV_32F ? m.at<float>(r, c) : m.at<double>(r, c);
+}
+
+static bool distorted(const cv::Mat& distCoeffs){
+    return !distCoeffs.empty() && cv::countNonZero(distCoeffs) > 0;
+}
+
+void PoseBatch::solve(const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, PoseBatchBuffers& buffers, vector<cv::Vec3d>& rvecs, vector<cv::Vec3d>& tvecs){
+    int n = corners.size() / 4;
+    buffers.count = n;
+    for (int k = 0; k < 8; k++){
+        buffers.quad[k].resize(n);
+    }
+    for (int k = 0; k < 12; k++){
+        buffers.pose[k].resize(n);
+    }
+    rvecs.resize(n);
+    tvecs.resize(n);
+    if (n == 0){
+        return;
+    }
+
+    // move the corners onto the normalized image plane (z = 1), without distortion that is just the inverse camera matrix
+    if (distorted(distCoeffs)){
+        cv::undistortPoints(corners, buffers.normalized, cameraMatrix, distCoeffs);
+        for (int i = 0; i < n; i++){
+            for (int c = 0; c < 4; c++){
+                buffers.quad[2 * c][i] = buffers.normalized[4 * i + c].x;
+                buffers.quad[2 * c + 1][i] = buffers.normalized[4 * i + c].y;
+            }
+        }
+    } else {
+        float fx = element(cameraMatrix, 0, 0), fy = element(cameraMatrix, 1, 1), skew = element(cameraMatrix, 0, 1);
+        float cx = element(cameraMatrix, 0, 2), cy = element(cameraMatrix, 1, 2);
+        for (int i = 0; i < n; i++){
+            for (int c = 0; c < 4; c++){
+                float y = (corners[4 * i + c].y - cy) / fy;
+                buffers.quad[2 * c][i] = (corners[4 * i + c].x - cx - skew * y) / fx;
+                buffers.quad[2 * c + 1][i] = y;
+            }
+        }
+    }
+
+    const float* x0 = buffers.quad[0].data(); const float* y0 = buffers.quad[1].data();
+    const float* x1 = buffers.quad[2].data(); const float* y1 = buffers.quad[3].data();
+    const float* x2 = buffers.quad[4].data(); const float* y2 = buffers.quad[5].data();
+    const float* x3 = buffers.quad[6].data(); const float* y3 = buffers.quad[7].data();
+    float* pose[12];
+    for (int k = 0; k < 12; k++){
+        pose[k] = buffers.pose[k].data();
+    }
+
+    // no branches in here, every marker goes through the same arithmetic so the loop vectorizes
+    for (int i = 0; i < n; i++){
+        // homography of the unit square onto the quad: H = [h1 h2 h3] with h3 = (x0, y0, 1)
+        float dx1 = x1[i] - x2[i], dx2 = x3[i] - x2[i], dx3 = x0[i] - x1[i] + x2[i] - x3[i];
+        float dy1 = y1[i] - y2[i], dy2 = y3[i] - y2[i], dy3 = y0[i] - y1[i] + y2[i] - y3[i];
+        float den = dx1 * dy2 - dx2 * dy1;
+        float g = (dx3 * dy2 - dx2 * dy3) / den;
+        float h = (dx1 * dy3 - dx3 * dy1) / den;
+        float h1x = x1[i] - x0[i] + g * x1[i], h1y = y1[i] - y0[i] + g * y1[i], h1z = g;
+        float h2x = x3[i] - x0[i] + h * x3[i], h2y = y3[i] - y0[i] + h * y3[i], h2z = h;
+
+        // H is the camera pose up to scale: h1 and h2 are the scaled x and y axes of the marker, h3 its scaled origin
+        float n1 = sqrt(h1x * h1x + h1y * h1y + h1z * h1z);
+        float n2 = sqrt(h2x * h2x + h2y * h2y + h2z * h2z);
+        float scale = 2 / (n1 + n2);
+        h1x /= n1; h1y /= n1; h1z /= n1;
+        h2x /= n2; h2y /= n2; h2z /= n2;
+
+        // with noisy corners both axes aren't exactly perpendicular, spread the correction evenly over both
+        float ax = h1x + h2x, ay = h1y + h2y, az = h1z + h2z;
+        float bx = h1x - h2x, by = h1y - h2y, bz = h1z - h2z;
+        float na = 0.70710678f / sqrt(ax * ax + ay * ay + az * az);
+        float nb = 0.70710678f / sqrt(bx * bx + by * by + bz * bz);
+        ax *= na; ay *= na; az *= na;
+        bx *= nb; by *= nb; bz *= nb;
+        float r1x = ax + bx, r1y = ay + by, r1z = az + bz;
+        float r2x = ax - bx, r2y = ay - by, r2z = az - bz;
+
+        pose[0][i] = r1x; pose[1][i] = r2x; pose[2][i] = r1y * r2z - r1z * r2y;
+        pose[3][i] = r1y; pose[4][i] = r2y; pose[5][i] = r1z * r2x - r1x * r2z;
+        pose[6][i] = r1z; pose[7][i] = r2z; pose[8][i] = r1x * r2y - r1y * r2x;
+        pose[9][i] = scale * x0[i];
+        pose[10][i] = scale * y0[i];
+        pose[11][i] = scale;
+    }
+
+    for (int i = 0; i < n; i++){
+        cv::Matx33d R;
+        for (int k = 0; k < 9; k++){
+            R(k / 3, k % 3) = pose[k][i];
+        }
+        cv::Rodrigues(R, rvecs[i]);
+        tvecs[i] = cv::Vec3d(pose[9][i], pose[10][i], pose[11][i]);
+    }
+}
+
+void PoseBatch::load(const vector<cv::Vec3d>& rvecs, const vector<cv::Vec3d>& tvecs, PoseBatchBuffers& buffers){
+    int n = rvecs.size();
+    buffers.count = n;
+    for (int k = 0; k < 12; k++){
+        buffers.pose[k].resize(n);
+    }
+    for (int i = 0; i < n; i++){
+        cv::Matx33d R;
+        cv::Rodrigues(rvecs[i], R);
+        for (int k = 0; k < 9; k++){
+            buffers.pose[k][i] = R(k / 3, k % 3);
+        }
+        for (int k = 0; k < 3; k++){
+            buffers.pose[9 + k][i] = tvecs[i][k];
+        }
+    }
+}
+
+void PoseBatch::projectionMatrices(const cv::Mat& cameraMatrix, const PoseBatchBuffers& buffers, vector<cv::Matx44f>& projections){
+    float fx = element(cameraMatrix, 0, 0), fy = element(cameraMatrix, 1, 1), skew = element(cameraMatrix, 0, 1);
+    float cx = element(cameraMatrix, 0, 2), cy = element(cameraMatrix, 1, 2);
+    projections.resize(buffers.count);
+    for (int i = 0; i < buffers.count; i++){
+        cv::Matx44f& P = projections[i];
+        // [R | t] row by row, the translation is the fourth column
+        float Rt[3][4];
+        for (int r = 0; r < 3; r++){
+            for (int c = 0; c < 3; c++){
+                Rt[r][c] = buffers.pose[r * 3 + c][i];
+            }
+            Rt[r][3] = buffers.pose[9 + r][i];
+        }
+        for (int c = 0; c < 4; c++){
+            P(0, c) = fx * Rt[0][c] + skew * Rt[1][c] + cx * Rt[2][c];
+            P(1, c) = fy * Rt[1][c] + cy * Rt[2][c];
+            P(2, c) = Rt[2][c];
+            P(3, c) = c == 3 ? 1 : 0;
+        }
+    }
+}
+
+void PoseBatch::projectVertices(const cv::Matx44f& projection, const cv::Point3f* vertices, int count, cv::Point2f* projected){
+    const cv::Matx44f& P = projection;
+#if defined(POSEBATCH_SSE)
+    // one column of the matrix per register, the product is a sum of the columns weighted by x, y, z and 1
+    __m128 c0 = _mm_setr_ps(P(0, 0), P(1, 0), P(2, 0), P(3, 0));
+    __m128 c1 = _mm_setr_ps(P(0, 1), P(1, 1), P(2, 1), P(3, 1));
+    __m128 c2 = _mm_setr_ps(P(0, 2), P(1, 2), P(2, 2), P(3, 2));
+    __m128 c3 = _mm_setr_ps(P(0, 3), P(1, 3), P(2, 3), P(3, 3));
+    for (int i = 0; i < count; i++){
+        __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(vertices[i].x)), _mm_mul_ps(c1, _mm_set1_ps(vertices[i].y))),
+                              _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(vertices[i].z)), c3));
+        // divide u and v by w
+        __m128 w = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+        _mm_storel_pi((__m64*)&projected[i], _mm_div_ps(p, w));
+    }
+#elif defined(POSEBATCH_NEON)
+    float32x4_t c0 = {P(0, 0), P(1, 0), P(2, 0), P(3, 0)};
+    float32x4_t c1 = {P(0, 1), P(1, 1), P(2, 1), P(3, 1)};
+    float32x4_t c2 = {P(0, 2), P(1, 2), P(2, 2), P(3, 2)};
+    float32x4_t c3 = {P(0, 3), P(1, 3), P(2, 3), P(3, 3)};
+    for (int i = 0; i < count; i++){
+        float32x4_t p = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(c3, c0, vertices[i].x), c1, vertices[i].y), c2, vertices[i].z);
+        float32x2_t uv = vdiv_f32(vget_low_f32(p), vdup_laneq_f32(p, 2));
+        vst1_f32(&projected[i].x, uv);
+    }
+#else
+    for (int i = 0; i < count; i++){
+        const cv::Point3f& v = vertices[i];
+        float u = P(0, 0) * v.x + P(0, 1) * v.y + P(0, 2) * v.z + P(0, 3);
+        float w = P(2, 0) * v.x + P(2, 1) * v.y + P(2, 2) * v.z + P(2, 3);
+        float t = P(1, 0) * v.x + P(1, 1) * v.y + P(1, 2) * v.z + P(1, 3);
+        projected[i] = cv::Point2f(u / w, t / w);
+    }
+#endif
+}
+
+void PoseBatch::projectCubes(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, PoseBatchBuffers& buffers, vector<cv::Matx44f>& projections, vector<cv::Point2f>& projectedPoints){
+    int n = buffers.count;
+    projectedPoints.resize(n * 8);
+    projectionMatrices(cameraMatrix, buffers, projections);
+
+    if (distorted(distCoeffs)){
+        for (int i = 0; i < n; i++){
+            cv::Matx33d R;
+            for (int k = 0; k < 9; k++){
+                R(k / 3, k % 3) = buffers.pose[k][i];
+            }
+            cv::Vec3d rvec, tvec(buffers.pose[9][i], buffers.pose[10][i], buffers.pose[11][i]);
+            cv::Rodrigues(R, rvec);
+            cv::projectPoints(CUBE, rvec, tvec, cameraMatrix, distCoeffs, cv::Mat(8, 1, CV_32FC2, &projectedPoints[i * 8]));
+        }
+        return;
+    }
+    for (int i = 0; i < n; i++){
+        projectVertices(projections[i], CUBE.data(), 8, &projectedPoints[i * 8]);
+    }
+}
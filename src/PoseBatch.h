@@ -0,0 +1,86 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+/* Scratch buffers of the batched pose estimation, every array holds one value per marker */
+struct PoseBatchBuffers{
+    vector<cv::Point2f> corners;        // 4 corners per marker, in the order (0,0) (1,0) (1,1) (0,1) of the unit square
+    vector<cv::Point2f> normalized;     // the same corners undistorted, only with distortion coefficients
+    vector<float> quad[8];              // x0, y0, x1, y1, x2, y2, x3, y3 on the normalized image plane
+    vector<float> pose[12];             // rotation matrix (row major) followed by the translation
+    int count = 0;                      // the number of markers in pose
+};
+
+/**
+ * Pose estimation and cube projection for all markers of a frame at once
+ *
+ * The markers are solved in closed form: the homography of the unit square onto the normalized image
+ * quad is written down directly (no equation system), its first two columns give the rotation and the
+ * third the translation. All steps are the same straight-line arithmetic for every marker and run over
+ * arrays with one value per marker, so the compiler vectorizes them across markers.
+ *
+ * The projection needs no cv::projectPoints either: every marker gets its 3x4 projection matrix once,
+ * and any batch of vertices on that marker is projected with a 4x4 product per vertex.
+*/
+class PoseBatch{
+    public:
+        /**
+         * Solves the poses of all markers
+         *
+         * @param corners 4 corners per marker, in the order (0,0) (1,0) (1,1) (0,1) of the unit square
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients, the corners are undistorted first unless they are all zero
+         * @param buffers The scratch buffers, buffers.pose receives the poses for projectCubes
+         * @param rvecs Receives the rotation vector of every marker
+         * @param tvecs Receives the translation vector of every marker, in marker side lengths
+        */
+        static void solve(const vector<cv::Point2f>& corners, const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, PoseBatchBuffers& buffers, vector<cv::Vec3d>& rvecs, vector<cv::Vec3d>& tvecs);
+
+        /**
+         * Loads poses solved elsewhere into buffers.pose, to project them with projectCubes
+         *
+         * @param rvecs The rotation vector of every marker
+         * @param tvecs The translation vector of every marker
+         * @param buffers The scratch buffers
+        */
+        static void load(const vector<cv::Vec3d>& rvecs, const vector<cv::Vec3d>& tvecs, PoseBatchBuffers& buffers);
+
+        /**
+         * Builds the projection matrix of every marker in buffers.pose, from marker space to pixels
+         *
+         * The top three rows are cameraMatrix * [R | t], the last row is (0, 0, 0, 1). The distortion
+         * coefficients are not part of it, so the projection is exact only when they are zero.
+         *
+         * @param cameraMatrix The camera matrix
+         * @param buffers The scratch buffers holding the poses
+         * @param projections Receives one matrix per marker
+        */
+        static void projectionMatrices(const cv::Mat& cameraMatrix, const PoseBatchBuffers& buffers, vector<cv::Matx44f>& projections);
+
+        /**
+         * Projects a batch of marker space vertices to pixels with a projection matrix of projectionMatrices
+         *
+         * A 4x4 matrix vector product per vertex (SSE or NEON) followed by the perspective division.
+         * Allocates nothing, the vertices can be any model drawn on the marker.
+         *
+         * @param projection The projection matrix of the marker
+         * @param vertices The vertices in marker space, in marker side lengths
+         * @param count The number of vertices
+         * @param projected Receives the pixel position of every vertex
+        */
+        static void projectVertices(const cv::Matx44f& projection, const cv::Point3f* vertices, int count, cv::Point2f* projected);
+
+        /**
+         * Projects the 8 points of the cube drawn on every marker in buffers.pose
+         *
+         * The points are in the order of MarkerDetection::projectCube.
+         *
+         * @param cameraMatrix The camera matrix
+         * @param distCoeffs The distortion coefficients, cv::projectPoints is used per marker unless they are all zero
+         * @param buffers The scratch buffers holding the poses
+         * @param projections Receives the projection matrix of every marker (projectionMatrices)
+         * @param projectedPoints Receives 8 points per marker, one marker after the other
+        */
+        static void projectCubes(const cv::Mat& cameraMatrix, const cv::Mat& distCoeffs, PoseBatchBuffers& buffers, vector<cv::Matx44f>& projections, vector<cv::Point2f>& projectedPoints);
+};
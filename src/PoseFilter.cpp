@@ -0,0 +1,110 @@
+#include "PoseFilter.h"
+
+using namespace std;
+
+// One-Euro parameters: the cutoff frequency of a still marker in Hz, how much it rises per unit of speed,
+// and the cutoff of the speed estimate itself
+static const double MIN_CUTOFF = 1.0;
+static const double ROTATION_BETA = 0.3;        // per radian per second
+static const double TRANSLATION_BETA = 0.3;     // per marker side length per second
+static const double DERIVATIVE_CUTOFF = 1.0;
+// a marker unseen for longer starts over, and a pose is never extrapolated further than this
+static const double RESET_AFTER = 0.5;
+static const double MAX_PREDICTION = 0.1;
+
+// weight of a new sample for a first order low-pass filter with the given cutoff frequency
+static double smoothingFactor(double cutoff, double dt){
+    double tau = 1.0 / (2 * CV_PI * cutoff);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+PoseFilter::PoseFilter(int markerCount)
+    : slotOfMarker(max(markerCount, 0), -1), updates(0), updateTicks(0){
+}
+
+int PoseFilter::allocateSlot(int markerId){
+    int slot = markerOfSlot.size();
+    markerOfSlot.push_back(markerId);
+    lastTime.push_back(0);
+    for (int c = 0; c < 6; c++){
+        value[c].push_back(0);
+        velocity[c].push_back(0);
+    }
+    slotOfMarker[markerId] = slot;
+    return slot;
+}
+
+void PoseFilter::update(int markerId, double time, const cv::Vec3d& rvec, const cv::Vec3d& tvec){
+    if (markerId < 0 || markerId >= (int)slotOfMarker.size()){
+        return;
+    }
+    int64_t start = cv::getTickCount();
+
+    int slot = slotOfMarker[markerId];
+    bool fresh = slot == -1;
+    if (fresh){
+        slot = allocateSlot(markerId);
+    }
+    double dt = time - lastTime[slot];
+    double measured[6] = {rvec[0], rvec[1], rvec[2], tvec[0], tvec[1], tvec[2]};
+
+    if (fresh || dt > RESET_AFTER){
+        for (int c = 0; c < 6; c++){
+            value[c][slot] = measured[c];
+            velocity[c][slot] = 0;
+        }
+        lastTime[slot] = time;
+    } else if (dt > 0){
+        // a rotation of angle a around an axis is also one of a - 2 pi around it, use whichever is closer to the
+        // filtered rotation so the filter doesn't average across the jump at pi
+        double angle = sqrt(measured[0] * measured[0] + measured[1] * measured[1] + measured[2] * measured[2]);
+        if (angle > 0){
+            double scale = (angle - 2 * CV_PI) / angle;
+            double direct = 0, flipped = 0;
+            for (int c = 0; c < 3; c++){
+                direct += (measured[c] - value[c][slot]) * (measured[c] - value[c][slot]);
+                flipped += (measured[c] * scale - value[c][slot]) * (measured[c] * scale - value[c][slot]);
+            }
+            if (flipped < direct){
+                for (int c = 0; c < 3; c++){
+                    measured[c] *= scale;
+                }
+            }
+        }
+
+        // first the derivative, its magnitude then sets the cutoff of the rotation and the translation
+        double derivativeAlpha = smoothingFactor(DERIVATIVE_CUTOFF, dt);
+        double speed[2] = {0, 0};
+        for (int c = 0; c < 6; c++){
+            double derivative = (measured[c] - value[c][slot]) / dt;
+            velocity[c][slot] += derivativeAlpha * (derivative - velocity[c][slot]);
+            speed[c / 3] += velocity[c][slot] * velocity[c][slot];
+        }
+        double alpha[2] = {smoothingFactor(MIN_CUTOFF + ROTATION_BETA * sqrt(speed[0]), dt),
+                           smoothingFactor(MIN_CUTOFF + TRANSLATION_BETA * sqrt(speed[1]), dt)};
+        for (int c = 0; c < 6; c++){
+            value[c][slot] += alpha[c / 3] * (measured[c] - value[c][slot]);
+        }
+        lastTime[slot] = time;
+    }
+
+    updateTicks += cv::getTickCount() - start;
+    updates++;
+}
+
+bool PoseFilter::predict(int markerId, double time, cv::Vec3d& rvec, cv::Vec3d& tvec) const{
+    if (markerId < 0 || markerId >= (int)slotOfMarker.size() || slotOfMarker[markerId] == -1){
+        return false;
+    }
+    int slot = slotOfMarker[markerId];
+    double ahead = min(max(time - lastTime[slot], 0.0), MAX_PREDICTION);
+    for (int c = 0; c < 3; c++){
+        rvec[c] = value[c][slot] + velocity[c][slot] * ahead;
+        tvec[c] = value[c + 3][slot] + velocity[c + 3][slot] * ahead;
+    }
+    return true;
+}
+
+double PoseFilter::microsPerUpdate() const{
+    return updates == 0 ? 0 : updateTicks / cv::getTickFrequency() * 1e6 / updates;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+
+using namespace std;
+
+/**
+ * Smooths the marker poses over time and predicts them for the moment the frame is shown
+ *
+ * Every marker has a One-Euro filter on its rotation and translation vector: a low-pass filter whose
+ * cutoff frequency rises with the speed of the marker, so a still marker doesn't jitter and a moving
+ * one doesn't lag. The filtered velocity extrapolates the pose from the capture time of the frame to the
+ * display time, which hides the latency of the pipeline.
+ *
+ * The state is kept as one array per quantity (structure of arrays), one slot per marker seen recently.
+ * Markers are keyed by their marker image (dictionary index / 4), every rotation of a marker image has
+ * the same pose. Only used from the render thread.
+*/
+class PoseFilter{
+    public:
+        /**
+         * @param markerCount The number of marker images in the dictionary
+        */
+        explicit PoseFilter(int markerCount);
+
+        /**
+         * Filters the pose of a marker measured in a frame
+         *
+         * A marker that hasn't been seen for a while starts over from the measured pose.
+         *
+         * @param markerId The marker image the pose belongs to (dictionary index / 4)
+         * @param time The capture time of the frame in seconds
+         * @param rvec The measured rotation vector
+         * @param tvec The measured translation vector
+        */
+        void update(int markerId, double time, const cv::Vec3d& rvec, const cv::Vec3d& tvec);
+
+        /**
+         * Predicts the pose of a marker at a given time from its filtered pose and velocity
+         *
+         * @param markerId The marker image (dictionary index / 4)
+         * @param time The time to predict the pose for in seconds, the pose is extrapolated by at most 0.1 seconds
+         * @param rvec Receives the rotation vector
+         * @param tvec Receives the translation vector
+         * @return false if the marker has no filter state
+        */
+        bool predict(int markerId, double time, cv::Vec3d& rvec, cv::Vec3d& tvec) const;
+
+        /* Average time of one update in microseconds, over all updates so far */
+        double microsPerUpdate() const;
+
+    private:
+        int allocateSlot(int markerId);
+
+        vector<int> slotOfMarker;       // slot of every marker image, -1 if it has none
+        vector<int> markerOfSlot;       // marker image of every slot
+        vector<double> lastTime;        // capture time of the last update of every slot
+
+        // x, y, z of the rotation vector followed by x, y, z of the translation vector, one array each
+        vector<double> value[6];        // filtered pose
+        vector<double> velocity[6];     // filtered derivative of the pose per second
+
+        long long updates;
+        int64_t updateTicks;
+};
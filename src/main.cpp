@@ -1,5 +1,13 @@
 #include "MarkerDetection.h"
 #include "ObjectRender.h"
+#include "FramePipeline.h"
+#include "FrameStats.h"
+#include "Benchmark.h"
+#include "MarkerDictCache.h"
+#include "ImageKernels.h"
+#include "PoseFilter.h"
+#include "CameraCalibration.h"
+#include "CalibrationTool.h"
 #include <opencv2/imgproc.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/core.hpp>
@@ -12,23 +20,115 @@ using namespace std;
 
 #define VIDEOPATH "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/MarkerMovie.MP4"
 #define MARKERPATH "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/markers"
-#define CAM_MTX (cv::Mat_<float>(3, 3) << 1000, 0.0, 500, 0.0, 1000, 500, 0.0, 0.0, 1.0)
+#define DICTIONARY_CACHE MARKERPATH ".dict"   // compiled marker dictionary, rebuilt when the marker images change
+#define FURNITURE_PATH "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/furniture.txt"   // the furniture models, see FurnitureModels.h
+#define FURNITURE_CACHE "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/furniture.mesh"   // compiled furniture models, rebuilt when the text file changes
+#define CALIBRATION_PATH "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/calibration.yml"   // camera matrix and distortion, .yml or .json
+#define CALIBRATION_BOARD "/mnt/c/Users/eberc/Desktop/all/Edu/sem6/AR/ARchitecture/resources/markers_all.png"   // the printed sheet of markers `calibrate` looks for
+#define CAM_MTX (cv::Mat_<float>(3, 3) << 1000, 0.0, 500, 0.0, 1000, 500, 0.0, 0.0, 1.0)   // used when there is no calibration file
 #define CAM_DIST (cv::Mat_<float>(1, 4) << 0, 0, 0, 0)
-
+#define UNDISTORT 1             // 0 passes the distortion to every pose solve, 1 undistorts only the marker corners, 2 remaps every frame (see UndistortMode)
+#define QUEUE_DEPTH 4           // frames buffered between the pipeline stages, trades latency against throughput
+#define DETECTION_WORKERS -1    // number of detection threads, -1 picks one per spare CPU core
+#define CAPTURE_YUV 0           // 1 asks the webcam for raw YUYV frames, the detection then reads the Y plane without any color conversion
+#define DECODE_THREADS 1        // threads decoding the candidates of one frame, only worth raising with few detection workers
+#define ADAPTIVE_THRESHOLD 0    // 1 binarizes each frame against the local mean instead of a fixed threshold, for uneven lighting
+#define THRESHOLD_THREADS -1    // stripes of a frame binarized in parallel in adaptive mode, -1 leaves the split to OpenCV's thread pool
+#define MIN_MARKER_SIZE 0       // side length in pixels of the smallest marker to detect, above 48 the contours are searched on a downscaled frame
+#define KEYFRAME_INTERVAL 0     // frames from one full frame scan to the next, the frames in between only search around the known markers (0 = off)
+#define OPTICAL_FLOW 0          // 1 follows the known markers with optical flow between the full scans instead, nothing is decoded then
+#define POSE_FILTER 0           // 1 smooths the marker poses over time and predicts them for the moment the frame is drawn
+#define BATCH_POSES 0           // 1 solves all poses of a frame at once in closed form, cheaper with many markers but a little less accurate
+
+// the calibration file, or the default camera matrix without distortion when there is none
+static CameraIntrinsics loadIntrinsics(){
+    CameraIntrinsics intrinsics;
+    if (CameraCalibration::load(CALIBRATION_PATH, intrinsics)){
+        cout << "[CV] loaded camera calibration from " << CALIBRATION_PATH << endl;
+        return intrinsics;
+    }
+    cout << "[CV] No camera calibration at " << CALIBRATION_PATH << ", using the default camera matrix" << endl;
+    cv::Mat(CAM_MTX).convertTo(intrinsics.cameraMatrix, CV_64F);
+    cv::Mat(CAM_DIST).convertTo(intrinsics.distCoeffs, CV_64F);
+    return intrinsics;
+}
 
 int main(int argc, char const *argv[]){
 
-    // check if debug mode is enabled
+    // ./ARchitecture bench <name> [frames] runs one of the offline benchmarks on the video file
+    if (argc >= 2 && string(argv[1]) == "bench"){
+        BenchmarkConfig benchmarkConfig;
+        benchmarkConfig.videoPath = VIDEOPATH;
+        benchmarkConfig.markerPath = MARKERPATH;
+        benchmarkConfig.dictionaryCache = DICTIONARY_CACHE;
+        benchmarkConfig.furniturePath = FURNITURE_PATH;
+        benchmarkConfig.furnitureCache = FURNITURE_CACHE;
+        CameraIntrinsics intrinsics = loadIntrinsics();
+        benchmarkConfig.cameraMatrix = intrinsics.cameraMatrix;
+        benchmarkConfig.distCoeffs = intrinsics.distCoeffs;
+        return Benchmark::run(argc, argv, benchmarkConfig);
+    }
+
+    // ./ARchitecture calibrate [video] [views] calibrates the camera on the printed marker sheet and writes CALIBRATION_PATH
+    if (argc >= 2 && string(argv[1]) == "calibrate"){
+        CalibrationConfig calibrationConfig;
+        calibrationConfig.markerPath = MARKERPATH;
+        calibrationConfig.dictionaryCache = DICTIONARY_CACHE;
+        calibrationConfig.boardPath = CALIBRATION_BOARD;
+        calibrationConfig.calibrationPath = CALIBRATION_PATH;
+        return CalibrationTool::run(argc, argv, calibrationConfig);
+    }
+
+    // check if debug mode is enabled: 1 shows every debug window, -1 hides the ID and Pose overlay windows too
     bool debug = false;
+    bool showOverlays = true;
     if (argc >= 2){
-        if (atoi(argv[1]) == 1){
+        int debugLevel = atoi(argv[1]);
+        if (debugLevel == 1){
             debug = true;
             cout << "[prog] Debug mode enabled" << endl;
+        } else if (debugLevel == -1){
+            showOverlays = false;
+            cout << "[prog] ID/Pose overlay windows disabled" << endl;
         }
     }
 
+    // optional pipeline settings: <debug> <queue depth> <detection workers> <decode threads> <adaptive threshold>
+    PipelineConfig pipelineConfig;
+    pipelineConfig.queueDepth = QUEUE_DEPTH;
+    pipelineConfig.detectionWorkers = DETECTION_WORKERS;
+    pipelineConfig.decodeThreads = DECODE_THREADS;
+    pipelineConfig.adaptiveThreshold = ADAPTIVE_THRESHOLD;
+    pipelineConfig.thresholdThreads = THRESHOLD_THREADS;
+    pipelineConfig.minMarkerSize = MIN_MARKER_SIZE;
+    pipelineConfig.keyframeInterval = KEYFRAME_INTERVAL;
+    pipelineConfig.opticalFlow = OPTICAL_FLOW;
+    pipelineConfig.projectPoses = showOverlays && !POSE_FILTER;
+    pipelineConfig.batchPoses = BATCH_POSES;
+    pipelineConfig.undistort = UNDISTORT;
+    if (argc >= 3){
+        pipelineConfig.queueDepth = max(1, atoi(argv[2]));
+    }
+    if (argc >= 4){
+        pipelineConfig.detectionWorkers = atoi(argv[3]);
+    }
+    if (argc >= 5){
+        pipelineConfig.decodeThreads = max(1, atoi(argv[4]));
+    }
+    if (argc >= 6){
+        pipelineConfig.adaptiveThreshold = atoi(argv[5]) != 0;
+    }
+    if (pipelineConfig.detectionWorkers < 0){
+        // leave one core for the capture thread and one for the render thread
+        pipelineConfig.detectionWorkers = max(1, (int)thread::hardware_concurrency() - 2);
+    }
+    if (debug){
+        // the debug windows of the detector have to be shown from the GUI thread
+        pipelineConfig.detectionWorkers = 0;
+    }
+    pipelineConfig.debug = debug;
+
     /* ======================================== INITIALIZATION ======================================== */
-    cv::Mat frame;
     cv::VideoCapture cap(0, cv::CAP_FFMPEG);
 
     // check if webcam is detected
@@ -40,6 +140,15 @@ int main(int argc, char const *argv[]){
             exit(0);
         }
         cout << "[CV] Video file detected" << endl;
+    } else if (CAPTURE_YUV){
+        // skip the BGR conversion of the backend, the render thread converts the frame while uploading it
+        cap.set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('Y', 'U', 'Y', 'V'));
+        cap.set(cv::CAP_PROP_CONVERT_RGB, 0);
+        if (cap.get(cv::CAP_PROP_CONVERT_RGB) == 0){
+            cout << "[CV] Capturing raw YUYV frames" << endl;
+        } else {
+            cout << "[CV] Webcam backend can't capture raw YUYV frames, capturing BGR" << endl;
+        }
     }
 
     // print out video metadata
@@ -53,17 +162,24 @@ int main(int argc, char const *argv[]){
     cout << "\tFrame Dimension: " << frame_width << "x" << frame_height << endl;
     cout << "=========================================" << endl;
 
-    // read the files in a directory
-    vector<string> markerPaths;
-    for (const auto & entry : filesystem::directory_iterator(MARKERPATH)){
-        markerPaths.push_back(entry.path());
+    // the calibration may have been made at another resolution of the same camera
+    CameraIntrinsics intrinsics = CameraCalibration::scaledTo(loadIntrinsics(), cv::Size(frame_width, frame_height));
+    if (pipelineConfig.undistort == UNDISTORT_FRAME){
+        CameraCalibration::loadOrBuildRemap(CALIBRATION_PATH, intrinsics, cv::Size(frame_width, frame_height), pipelineConfig.undistortMap1, pipelineConfig.undistortMap2);
     }
-    // sort the files in ascending order (marker0, marker1, marker2, ...)
-    std::sort(markerPaths.begin(), markerPaths.end());
+    cout << "=========================================" << endl;
+
+    // construct dictionary, or load it from the cache when the marker images haven't changed
+    MarkerDict dict = MarkerDictCache::loadOrBuild(MARKERPATH, DICTIONARY_CACHE);
+    cout << "[prog] " << dict.codes.size() << " dictionary codes, matched with " << MarkerCode::implementation() << " popcount" << endl;
+    cout << "[prog] binarizing BGR frames with the " << ImageKernels::implementation() << " kernel" << endl;
 
-    // construct dictionary
-    cout << "[prog] constructing dictionary for markers:" << endl;
-    MarkerDict dict = MarkerDetection::constructMarkerDictionary(markerPaths);
+    // the furniture models are only needed until they are uploaded
+    FurnitureMeshes furniture;
+    if (!FurnitureModels::loadOrCompile(FURNITURE_PATH, FURNITURE_CACHE, furniture)){
+        cout << "=========================================" << endl;
+        return -1;
+    }
     cout << "=========================================" << endl;
 
 
@@ -76,6 +192,12 @@ int main(int argc, char const *argv[]){
     cout << "[GLFW] GLFW initialized" << endl;
     cout << "=========================================" << endl;
 
+    // everything is drawn from vertex arrays with GLSL 3.30 shaders, so a core profile context is enough
+    // (forward compatible, which macOS requires for anything above OpenGL 2.1)
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
     GLFWwindow* window = glfwCreateWindow(frame_width, frame_height, "render", NULL, NULL);
     if (!window)
     {
@@ -85,323 +207,176 @@ int main(int argc, char const *argv[]){
         return -1;
     }
     glfwMakeContextCurrent(window);
+
+    // the scene is drawn from vertex buffers with shaders, both need the GL functions GLEW loads (glewExperimental
+    // makes it load them from a core profile context too)
+    glewExperimental = GL_TRUE;
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK){
+        cout << "[GLFW] Failed to initialize GLEW: " << glewGetErrorString(glewStatus) << endl;
+        glfwTerminate();
+        return -1;
+    }
+    if (!GLEW_VERSION_3_3){
+        cout << "[GLFW] An OpenGL 3.3 core profile context is needed, the driver offers " << glGetString(GL_VERSION) << endl;
+        glfwTerminate();
+        return -1;
+    }
+    // the furniture is distorted like the drawn frame, a remapped frame has no distortion left
+    SceneBuffers sceneBuffers;
+    cv::Mat sceneDistCoeffs = pipelineConfig.undistort == UNDISTORT_FRAME ? cv::Mat() : intrinsics.distCoeffs;
+    if (!ObjectRender::initScene(furniture, intrinsics.cameraMatrix, sceneDistCoeffs, frame_width, frame_height, sceneBuffers)){
+        glfwTerminate();
+        return -1;
+    }
+    furniture = FurnitureMeshes();
+    cout << "=========================================" << endl;
     
+    // capture and detection run on their own threads, this thread only renders
+    cout << "[prog] pipeline: queue depth " << pipelineConfig.queueDepth << ", " << pipelineConfig.detectionWorkers << " detection worker(s), " << pipelineConfig.decodeThreads << " decode thread(s) per frame, "
+         << (pipelineConfig.adaptiveThreshold ? "adaptive" : "global") << " threshold, contour search on pyramid level "
+         << MarkerDetection::searchLevel(pipelineConfig.minMarkerSize) << ", full scan every " << max(pipelineConfig.keyframeInterval, 1) << " frame(s)"
+         << (pipelineConfig.opticalFlow && pipelineConfig.keyframeInterval > 1 ? " with optical flow in between" : "") << endl;
+    cout << "=========================================" << endl;
+    FramePipeline pipeline(cap, dict, intrinsics.cameraMatrix, intrinsics.distCoeffs, pipelineConfig);
+    pipeline.start();
+
     /* ======================================== MAIN LOOP STARTS HERE ======================================== */
-    while(cap.read(frame)){
-        cv::Mat frame_clone = frame.clone();
-        cv::Mat frame_pose = frame.clone();
-        cv::Mat frame_render = frame.clone();
-
-        // detect all markers in the frame
-        vector<MarkerResult> results = MarkerDetection::detectMarker(frame_clone, dict, 0, debug);
-
-        // draw the detected markers on the frame and print their IDs
-        for (int i = 0; i < results.size(); i++){
-            cv::putText(frame_clone, to_string(results[i].index), results[i].corners[0], cv::FONT_HERSHEY_PLAIN, 1, cv::Scalar(32, 32, 255), 2);
-            cv::drawContours(frame_clone, vector<vector<cv::Point>>{results[i].corners}, 0, cv::Scalar(0, 255, 32), 1);
-        }
-        
-        // Convert the frame to OpenGL texture format
-        cv::flip(frame_render, frame_render, 0);  // Flip vertically
-        cv::cvtColor(frame_render, frame_render, cv::COLOR_BGR2RGB);
-
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-
-        // Set up the texture mapping
-        glEnable(GL_TEXTURE_2D);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
-
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, frame_width, frame_height, 0, GL_RGB, GL_UNSIGNED_BYTE, frame_render.data);
-
-        // draw a rectangle that covers the entire screen, overlaying the webcam feed as a texture
-        glMatrixMode(GL_MODELVIEW);
-        glLoadIdentity();
-        glBegin(GL_QUADS);
-            glTexCoord2f(0.0, 0.0); glVertex3f(-1.0, -1.0, 0.0);
-            glTexCoord2f(1.0, 0.0); glVertex3f(1.0, -1.0, 0.0);
-            glTexCoord2f(1.0, 1.0); glVertex3f(1.0, 1.0, 0.0);
-            glTexCoord2f(0.0, 1.0); glVertex3f(-1.0, 1.0, 0.0);
-        glEnd();    
-
-        // Set up the camera
-        glMatrixMode(GL_PROJECTION);
-        glPushMatrix();
-        glLoadIdentity();
-        glOrtho(-1, 1, -1, 1, -1, 10);	
-        
-        // store wall marker corners in GL coordinates
-        map<string, vector<cv::Point2f>> wallMarkerCorners;
-        
-        // initialize GL coordinates for each object detected in the frame to put in front of the wall
-        vector<cv::Point2f> GLPoints_Table1x1;
-        vector<cv::Point2f> GLPoints_Table1x2;
-        vector<cv::Point2f> GLPoints_BasicChair;
-        vector<cv::Point2f> GLPoints_Bed;
-        vector<cv::Point2f> GLPoints_SmallSofa;
-        vector<cv::Point2f> GLPoints_LongSofa;
-        vector<cv::Point2f> GLPoints_TableForSofa;
-        vector<cv::Point2f> GLPoints_DiningTable;
-        vector<cv::Point2f> GLPoints_DiningChair;
-        vector<cv::Point2f> GLPoints_TV;
-        vector<cv::Point2f> GLPoints_Carpet;
-        vector<cv::Point2f> GLPoints_Bookshelf;
-          
-        for (MarkerResult& res : results){
-            vector<cv::Point2f> projectedPoints = MarkerDetection::poseEstimation(dict.orientations[res.index], res.corners, CAM_MTX, CAM_DIST);
-
-            // store wall marker corners for easy access later
-            cv::Point2f zero = projectedPoints[0];
-            cv::Point2f one = projectedPoints[1];
-            cv::Point2f two = projectedPoints[2];
-            cv::Point2f three = projectedPoints[3];
-            cv::Point2f four = projectedPoints[4];
-            cv::Point2f five = projectedPoints[5];
-            cv::Point2f six = projectedPoints[6];
-            cv::Point2f seven = projectedPoints[7];
-
-            // draw axis lines on the frame for debugging
-            cv::line(frame_pose, zero, one, cv::Scalar(0, 0, 255), 1);
-            cv::line(frame_pose, two, zero, cv::Scalar(0, 255, 0), 1);
-            cv::line(frame_pose, zero, three, cv::Scalar(255, 0, 0), 1);
-            cv::line(frame_pose, one, four, cv::Scalar(255, 0, 255), 1);
-            cv::line(frame_pose, four, two, cv::Scalar(255, 0, 255), 1);
-            cv::line(frame_pose, one, six, cv::Scalar(255, 255, 0), 1);
-            cv::line(frame_pose, four, five, cv::Scalar(255, 255, 0), 1);
-            cv::line(frame_pose, two, seven, cv::Scalar(255, 255, 0), 1);
-            cv::line(frame_pose, five, seven, cv::Scalar(0, 255, 255), 1);
-            cv::line(frame_pose, three, seven, cv::Scalar(0, 255, 255), 1);
-            cv::line(frame_pose, five, six, cv::Scalar(0, 255, 255), 1);
-            cv::line(frame_pose, three, six, cv::Scalar(0, 255, 255), 1);
-
-            // draw axis points on the frame for debugging
-            cv::circle(frame_pose, zero, 3, cv::Scalar(75, 25, 230), -1);       // red      - lower top left
-            cv::circle(frame_pose, one, 3, cv::Scalar(48, 130, 245), -1);       // orange   - lower top right
-            cv::circle(frame_pose, two, 3, cv::Scalar(25, 255, 255), -1);       // yellow   - lower bottom left
-            cv::circle(frame_pose, three, 3, cv::Scalar(60, 245, 210), -1);     // lime     - upper top left
-            cv::circle(frame_pose, four, 3, cv::Scalar(75, 180, 60), -1);       // green    - lower bottom right
-            cv::circle(frame_pose, five, 3, cv::Scalar(240, 240, 70), -1);      // cyan     - upper bottom right
-            cv::circle(frame_pose, six, 3, cv::Scalar(200, 130, 0), -1);        // blue     - upper top left
-            cv::circle(frame_pose, seven, 3, cv::Scalar(180, 30, 145), -1);     // purple   - upper bottom left
-
-            cv::circle(frame_pose, ObjectRender::vectorAddRelative(cv::Point2f(one.x, one.y), cv::Point2f(two.x, two.y), zero, 0.5,0.5), 3, cv::Scalar(48, 130, 245), -1);
-
-            // and put a text on the image for the projected points
-            if (debug){
-                cv::putText(frame_pose, "0", zero, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(75, 25, 230), 1);
-                cv::putText(frame_pose, "1", one, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(48, 130, 245), 1);
-                cv::putText(frame_pose, "2", two, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(25, 255, 255), 1);
-                cv::putText(frame_pose, "3", three, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(60, 245, 210), 1);
-                cv::putText(frame_pose, "4", four, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(75, 180, 60), 1);
-                cv::putText(frame_pose, "5", five, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(240, 240, 70), 1);
-                cv::putText(frame_pose, "6", six, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 130, 0), 1);
-                cv::putText(frame_pose, "7", seven, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(180, 30, 145), 1);
+    FrameResult processed;
+    PoseFilter poseFilter(dict.codes.size() / 4);
+    PoseBatchBuffers poseBuffers;
+    const cv::Mat& cameraMatrix = intrinsics.cameraMatrix;
+    const cv::Mat& distCoeffs = pipeline.projectionDistCoeffs();
+    // the overlays are drawn into copies of the frame, kept across frames so their buffers are reused
+    cv::Mat frame_clone;
+    cv::Mat frame_pose;
+    while(pipeline.nextResult(processed)){
+        FrameStats::frames++;
+        const cv::Mat& frame = processed.frame;
+        vector<MarkerResult>& results = processed.markers;
+
+        // filter the measured poses and draw them where the markers are now rather than when the frame was captured
+        if (POSE_FILTER){
+            double displayTime = FramePipeline::now();
+            for (int i = 0; i < results.size(); i++){
+                int markerId = results[i].index / 4;
+                poseFilter.update(markerId, processed.captureTime, processed.rvecs[i], processed.tvecs[i]);
+                poseFilter.predict(markerId, displayTime, processed.rvecs[i], processed.tvecs[i]);
             }
-            // convert projected points to GL coordinates 
-            vector<cv::Point2f> projectedGLPoints = ObjectRender::convertToGLCoords(projectedPoints, frame_width, frame_height);
-            
-            glMatrixMode(GL_MODELVIEW);
-            glLoadIdentity();
-            // draw the isometric walls on the four markers
-            if (0 <= res.index && res.index <= 3){
-                 wallMarkerCorners.insert(pair<string, vector<cv::Point2f>>("topLeft", projectedGLPoints));
-            } else if (4 <= res.index && res.index <= 7){
-                 wallMarkerCorners.insert(pair<string, vector<cv::Point2f>>("topRight", projectedGLPoints));
-            } else if (8 <= res.index && res.index <= 11){
-                 wallMarkerCorners.insert(pair<string, vector<cv::Point2f>>("bottomRight", projectedGLPoints));
-            } else if (12 <= res.index && res.index <= 15){
-                 wallMarkerCorners.insert(pair<string, vector<cv::Point2f>>("bottomLeft", projectedGLPoints));
+            // the room is drawn from the poses themselves, only the overlays need the projected cubes
+            if (showOverlays){
+                PoseBatch::load(processed.rvecs, processed.tvecs, poseBuffers);
+                PoseBatch::projectCubes(cameraMatrix, distCoeffs, poseBuffers, processed.projections, processed.projectedPoints);
             }
+        }
 
-            // draw detected objects on the markers 
-            if (res.index >= 16 && res.index <= 19) {
-                GLPoints_Table1x1 = projectedGLPoints;
-            } else if (res.index >= 20 && res.index <= 23) {
-                GLPoints_Table1x2 = projectedGLPoints;
-            } else if (res.index >= 24 && res.index <= 27) {
-                GLPoints_BasicChair = projectedGLPoints;
-            } else if (res.index >= 28 && res.index <= 31) {
-                GLPoints_Bed = projectedGLPoints;
-            } else if (res.index >= 32 && res.index <= 35) {
-                GLPoints_SmallSofa = projectedGLPoints;
-            } else if (res.index >= 36 && res.index <= 39) {
-                GLPoints_LongSofa = projectedGLPoints;
-            } else if (res.index >= 40 && res.index <= 43) {
-                GLPoints_TableForSofa = projectedGLPoints;
-            } else if (res.index >= 44 && res.index <= 47) {
-                GLPoints_DiningTable = projectedGLPoints;
-            } else if (res.index >= 48 && res.index <= 51) {
-                GLPoints_DiningChair = projectedGLPoints;
-            } else if (res.index >= 52 && res.index <= 55) {
-                GLPoints_TV = projectedGLPoints;
-            } else if (res.index >= 56 && res.index <= 59) {
-                GLPoints_Carpet = projectedGLPoints;
-            } else if (res.index >= 60 && res.index <= 63) {
-                GLPoints_Bookshelf = projectedGLPoints;
+        // only make the copies when the overlays are shown
+        if (showOverlays){
+            if (frame.channels() == 2){
+                cv::cvtColor(frame, frame_clone, cv::COLOR_YUV2BGR_YUYV);
+                FrameStats::countCopy(frame_clone);
+            } else {
+                FrameStats::copy(frame, frame_clone);
+            }
+            FrameStats::copy(frame_clone, frame_pose);
+
+            // draw the detected markers on the frame and print their IDs
+            for (int i = 0; i < results.size(); i++){
+                // the corners are sub-pixel, the drawing functions round them to whole pixels
+                const vector<cv::Point2f>& corners = results[i].corners;
+                cv::putText(frame_clone, to_string(results[i].index), corners[0], cv::FONT_HERSHEY_PLAIN, 1, cv::Scalar(32, 32, 255), 2);
+                for (int c = 0; c < 4; c++){
+                    cv::line(frame_clone, corners[c], corners[(c + 1) % 4], cv::Scalar(0, 255, 32), 1);
+                }
             }
-            
-            
 
+            // draw the projected cube of every marker on the frame for debugging
+            for (int i = 0; i < results.size(); i++){
+                const cv::Point2f* projectedPoints = &processed.projectedPoints[i * 8];
+                cv::Point2f zero = projectedPoints[0];
+                cv::Point2f one = projectedPoints[1];
+                cv::Point2f two = projectedPoints[2];
+                cv::Point2f three = projectedPoints[3];
+                cv::Point2f four = projectedPoints[4];
+                cv::Point2f five = projectedPoints[5];
+                cv::Point2f six = projectedPoints[6];
+                cv::Point2f seven = projectedPoints[7];
+
+                // draw axis lines on the frame for debugging
+                cv::line(frame_pose, zero, one, cv::Scalar(0, 0, 255), 1);
+                cv::line(frame_pose, two, zero, cv::Scalar(0, 255, 0), 1);
+                cv::line(frame_pose, zero, three, cv::Scalar(255, 0, 0), 1);
+                cv::line(frame_pose, one, four, cv::Scalar(255, 0, 255), 1);
+                cv::line(frame_pose, four, two, cv::Scalar(255, 0, 255), 1);
+                cv::line(frame_pose, one, six, cv::Scalar(255, 255, 0), 1);
+                cv::line(frame_pose, four, five, cv::Scalar(255, 255, 0), 1);
+                cv::line(frame_pose, two, seven, cv::Scalar(255, 255, 0), 1);
+                cv::line(frame_pose, five, seven, cv::Scalar(0, 255, 255), 1);
+                cv::line(frame_pose, three, seven, cv::Scalar(0, 255, 255), 1);
+                cv::line(frame_pose, five, six, cv::Scalar(0, 255, 255), 1);
+                cv::line(frame_pose, three, six, cv::Scalar(0, 255, 255), 1);
+
+                // draw axis points on the frame for debugging
+                cv::circle(frame_pose, zero, 3, cv::Scalar(75, 25, 230), -1);       // red      - lower top left
+                cv::circle(frame_pose, one, 3, cv::Scalar(48, 130, 245), -1);       // orange   - lower top right
+                cv::circle(frame_pose, two, 3, cv::Scalar(25, 255, 255), -1);       // yellow   - lower bottom left
+                cv::circle(frame_pose, three, 3, cv::Scalar(60, 245, 210), -1);     // lime     - upper top left
+                cv::circle(frame_pose, four, 3, cv::Scalar(75, 180, 60), -1);       // green    - lower bottom right
+                cv::circle(frame_pose, five, 3, cv::Scalar(240, 240, 70), -1);      // cyan     - upper bottom right
+                cv::circle(frame_pose, six, 3, cv::Scalar(200, 130, 0), -1);        // blue     - upper top left
+                cv::circle(frame_pose, seven, 3, cv::Scalar(180, 30, 145), -1);     // purple   - upper bottom left
+
+                cv::circle(frame_pose, ObjectRender::vectorAddRelative(cv::Point2f(one.x, one.y), cv::Point2f(two.x, two.y), zero, 0.5,0.5), 3, cv::Scalar(48, 130, 245), -1);
+
+                // and put a text on the image for the projected points
+                if (debug){
+                    cv::putText(frame_pose, "0", zero, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(75, 25, 230), 1);
+                    cv::putText(frame_pose, "1", one, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(48, 130, 245), 1);
+                    cv::putText(frame_pose, "2", two, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(25, 255, 255), 1);
+                    cv::putText(frame_pose, "3", three, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(60, 245, 210), 1);
+                    cv::putText(frame_pose, "4", four, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(75, 180, 60), 1);
+                    cv::putText(frame_pose, "5", five, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(240, 240, 70), 1);
+                    cv::putText(frame_pose, "6", six, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(200, 130, 0), 1);
+                    cv::putText(frame_pose, "7", seven, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(180, 30, 145), 1);
+                }
+            }
         }
 
-        // once all four markers are detected, draw the walls
-        if (wallMarkerCorners.size() == 4) {
-            vector<string> sortedWallName = ObjectRender::sortWallMarker(wallMarkerCorners, frame_height);
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            // beige
-            vector<GLfloat> floorColor{0.851,0.725,0.608};
-            vector<GLfloat> leftColor{1.,0.941,0.859};
-            vector<GLfloat> rightColor{0.933,0.851,0.769};
-            vector<GLfloat> ceilingColor{0.98,0.941,0.902};
-            vector<vector<GLfloat>> wallColors{floorColor, leftColor, rightColor, ceilingColor};
-            ObjectRender::drawWalls(wallMarkerCorners, sortedWallName, wallColors, true, true , 1.0f);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // Initialize the colors used for the objects (can be changed as needed)
-        // baby blue
-        vector<GLfloat> babyBlue_ColorLeft{0.663,0.847,0.914};
-        vector<GLfloat> babyBlue_ColorRight{0.529,0.675,0.729};
-        vector<GLfloat> babyBlue_ColorDark{0.396,0.506,0.545};
-        vector<vector<GLfloat>> babyBlue{babyBlue_ColorLeft, babyBlue_ColorRight, babyBlue_ColorDark};
-        // orange salmom
-        vector<GLfloat> orangeSalmon_ColorTop{0.937,0.808,0.761};
-        vector<GLfloat> orangeSalmon_topColorLeft{0.914,0.729,0.663};
-        vector<GLfloat> orangeSalmon_topColorRight{0.82,0.655,0.596};
-        vector<GLfloat> orangeSalmon_topColorDark{0.729,0.58,0.529};
-        vector<vector<GLfloat>> orangeSalmon{orangeSalmon_ColorTop, orangeSalmon_topColorLeft, orangeSalmon_topColorRight, orangeSalmon_topColorDark};
-        
-        // draw table 1x1
-        if (GLPoints_Table1x1.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawTable1x1(GLPoints_Table1x1, babyBlue, orangeSalmon, 0.8);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw table 1x2
-        if (GLPoints_Table1x2.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawTable1x2(GLPoints_Table1x2, babyBlue, orangeSalmon, 0.8);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw basic chair
-        if (GLPoints_BasicChair.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawBasicChair(GLPoints_BasicChair, babyBlue, orangeSalmon, 0.5);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw bed
-        if (GLPoints_Bed.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawBed(GLPoints_Bed, babyBlue, orangeSalmon, 1.0);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw small sofa
-        if (GLPoints_SmallSofa.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawSmallSofa(GLPoints_SmallSofa, babyBlue, orangeSalmon, 0.6);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw long sofa
-        if (GLPoints_LongSofa.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawLongSofa(GLPoints_LongSofa, babyBlue, orangeSalmon, 0.6);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw table for sofa
-        if (GLPoints_TableForSofa.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawTableForSofa(GLPoints_TableForSofa, babyBlue, orangeSalmon, 0.5);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw dining table
-        if (GLPoints_DiningTable.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawDiningTable(GLPoints_DiningTable, babyBlue, orangeSalmon, 0.6);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw dining chair
-        if (GLPoints_DiningChair.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawDiningChair(GLPoints_DiningChair, babyBlue, orangeSalmon, 0.4);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw TV
-        if (GLPoints_TV.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawTV(GLPoints_TV, babyBlue, orangeSalmon, 0.7);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw TV table
-        if (GLPoints_Carpet.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawCarpet(GLPoints_Carpet, babyBlue, orangeSalmon, 0.8);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        // draw TV table
-        if (GLPoints_Bookshelf.size() != 0){
-            glPushMatrix();
-            glDisable(GL_TEXTURE_2D);
-            ObjectRender::drawBookshelf(GLPoints_Bookshelf, babyBlue, orangeSalmon, 0.8);
-            glEnable(GL_TEXTURE_2D);
-            glPopMatrix();
-        }
-        
-        glMatrixMode(GL_PROJECTION);
-        glPopMatrix();
+        // draw the camera frame as the background and the room on top of it
+        ObjectRender::drawCameraFrame(frame, sceneBuffers);
+        ObjectRender::drawScene(dict, results, processed.rvecs, processed.tvecs, sceneBuffers);
 
-        cv::namedWindow("ID", cv::WINDOW_NORMAL);
-        cv::imshow("ID", frame_clone);
-        cv::namedWindow("Pose", cv::WINDOW_NORMAL);
-        cv::imshow("Pose", frame_pose);
+        if (showOverlays){
+            cv::namedWindow("ID", cv::WINDOW_NORMAL);
+            cv::imshow("ID", frame_clone);
+            cv::namedWindow("Pose", cv::WINDOW_NORMAL);
+            cv::imshow("Pose", frame_pose);
+        }
 
-        if (cv::waitKey(frame_rate) == 27){
+        // the frames come as fast as the pipeline delivers them, HighGUI only needs a moment to draw its windows
+        bool escape = showOverlays && cv::waitKey(1) == 27;
+        if (escape || glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS || glfwWindowShouldClose(window)){
             break;
         }
         glfwSwapBuffers(window);
         glfwPollEvents();
+
+        // hand the buffers of the drawn frame back for one of the next frames
+        pipeline.recycle(processed);
     }
+    pipeline.stop();
     cap.release();
 
+    cout << "=========================================" << endl;
+    cout << "[prog] " << FrameStats::frames << " frames, " << (long long)FrameStats::bytesCopiedPerFrame() << " bytes copied or converted per frame" << endl;
+    if (FrameStats::countingAllocations){
+        cout << "[prog] " << (long long)FrameStats::allocationsPerFrame() << " heap allocations per frame" << endl;
+    }
+    if (POSE_FILTER){
+        cout << "[prog] pose filter: " << poseFilter.microsPerUpdate() << " us per marker update" << endl;
+    }
+
+    ObjectRender::releaseScene(sceneBuffers);
     glfwTerminate();
 
     return 0;